@@ -1,11 +1,19 @@
 #pragma once
 #include <Arduino.h>
 #include <elapsedMillis.h>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#if defined(ARDUINO_ARCH_ESP32) && !defined(ARDUINO_HOST)
+#include <esp_timer.h>
+#endif
 
 using lpsd_ms = elapsedMillis;
 using time_ms = int32_t;
 using time_s = int32_t;
 using time_min = int32_t;
+using time_us = int64_t; // 64 bit, does not wrap (292k years)
 
 namespace util
 {
@@ -15,11 +23,128 @@ namespace util
         return millis();
     }
 
+    // wrap safe: valid for events less than 24 days ago
     inline time_ms since_ms(time_ms event_ms)
     {
-        return now_ms() - event_ms;
+        return time_ms(uint32_t(now_ms()) - uint32_t(event_ms));
     }
 
+    /**
+     * @brief Monotonic microseconds since boot, 64 bit
+     *
+     * ESP32: esp_timer, ESP8266: micros64(), host: virtual clock.
+     * Elsewhere the 32 bit micros() is extended by counting wraps, which
+     * needs a call at least every 71 minutes.
+     */
+    inline time_us now_us()
+    {
+#if defined(ARDUINO_HOST)
+        return time_us(host::clock::us());
+#elif defined(ARDUINO_ARCH_ESP32)
+        return esp_timer_get_time();
+#elif defined(ARDUINO_ARCH_ESP8266)
+        return time_us(micros64());
+#else
+        static uint32_t last = 0;
+        static uint32_t high = 0;
+        const uint32_t  now  = micros();
+        if (now < last)
+            high++;
+        last = now;
+        return time_us((uint64_t(high) << 32) | now);
+#endif
+    }
+
+    constexpr time_us ms_to_us(time_ms ms) { return time_us(ms) * 1000; }
+    constexpr time_ms us_to_ms(time_us us) { return time_ms(us / 1000); }
+    constexpr float   us_to_ms_f(time_us us) { return float(us) * 1e-3f; }
+    constexpr float   us_to_s_f(time_us us) { return float(us) * 1e-6f; }
+
+    /**
+     * @brief Measures elapsed time on the 64 bit clock
+     *
+     * Usage:
+     *
+     * util::Stopwatch since_loop;
+     * const time_us dt = since_loop.restart(); // lap, no time is lost between laps
+     */
+    class Stopwatch
+    {
+    public:
+        Stopwatch() : _start(now_us()) {}
+
+        void reset() { _start = now_us(); }
+
+        // elapsed time, restarts from the same clock reading (drift free laps)
+        time_us restart()
+        {
+            const time_us now     = now_us();
+            const time_us elapsed = now - _start;
+            _start                = now;
+            return elapsed;
+        }
+
+        time_us elapsed_us() const { return now_us() - _start; }
+        time_ms elapsed_ms() const { return us_to_ms(elapsed_us()); }
+        float   elapsed_s() const { return us_to_s_f(elapsed_us()); }
+
+    private:
+        time_us _start;
+    };
+
+    /**
+     * @brief Point in time on the 64 bit clock, one-shot or periodic without drift
+     *
+     * Usage:
+     *
+     * util::Deadline next;
+     * void loop() {
+     *   if (next.poll(250)) // every 250 us, phase locked to the first deadline
+     *     control();
+     * }
+     */
+    class Deadline
+    {
+    public:
+        Deadline() : _due(now_us()) {} // expired
+        explicit Deadline(time_us in_us) : _due(now_us() + in_us) {}
+
+        void set(time_us in_us) { _due = now_us() + in_us; }
+        void set_ms(time_ms in_ms) { set(ms_to_us(in_ms)); }
+
+        bool    expired() const { return now_us() >= _due; }
+        time_us remaining_us() const
+        {
+            const time_us left = _due - now_us();
+            return left > 0 ? left : 0;
+        }
+        time_us due_us() const { return _due; }
+
+        /**
+         * @brief true once per period, the next deadline is the previous one + period
+         *
+         * Missed periods are skipped instead of being caught up.
+         */
+        bool poll(time_us period_us)
+        {
+            const time_us now = now_us();
+            if (now < _due)
+                return false;
+            if (period_us <= 0)
+            {
+                _due = now;
+                return true;
+            }
+            _due += period_us;
+            if (_due <= now)
+                _due += ((now - _due) / period_us + 1) * period_us;
+            return true;
+        }
+
+    private:
+        time_us _due;
+    };
+
     inline float getRelative(time_ms timer, time_ms period)
     {
         if (period < timer)
@@ -34,4 +159,272 @@ namespace util
     {
         return getRelative(static_cast<time_ms>(timer), period);
     }
-}
\ No newline at end of file
+
+    /**
+     * @brief Cooperative scheduler for periodic tasks (replaces per-component elapsedMillis gates)
+     *
+     * Tasks are kept in a min-heap by deadline, run() only touches tasks that
+     * are due and runs them in deadline order. Each task keeps jitter/overrun
+     * statistics. If a task misses whole periods they are skipped (counted as
+     * overruns) instead of being run back to back.
+     *
+     * Usage:
+     *
+     * util::Scheduler<> scheduler;
+     *
+     * void setup() {
+     *   scheduler.add("led", 3000, [] { led.update(); });     // period in us
+     *   scheduler.add("motor", 3000, [] { motor.update(); });
+     *   scheduler.add("mqtt", 10000, [] { mqtt.loop(); });
+     * }
+     *
+     * void loop() {
+     *   scheduler.runAndSleep(); // or scheduler.run() if loop() has other work
+     * }
+     */
+    template <int MAX_TASKS = 16>
+    class Scheduler
+    {
+    public:
+        using Callback = std::function<void()>;
+
+        struct Stats
+        {
+            uint32_t runs            = 0;
+            uint32_t overruns        = 0; // skipped periods
+            uint32_t max_lateness_us = 0; // jitter: start time - deadline
+            uint32_t max_runtime_us  = 0;
+            uint64_t sum_lateness_us = 0;
+            uint64_t sum_runtime_us  = 0;
+
+            float avgLateness_us() const { return runs ? float(sum_lateness_us) / runs : 0; }
+            float avgRuntime_us() const { return runs ? float(sum_runtime_us) / runs : 0; }
+        };
+
+        /**
+         * @brief Register a periodic task
+         * @param name Static string, only used for printStats()
+         * @param period_us Period in microseconds, 0 = once on every run()
+         * @return task id, -1 if full
+         */
+        int add(const char* name, uint32_t period_us, Callback callback)
+        {
+            if (_num_tasks >= MAX_TASKS)
+            {
+                printf("ERROR in util::Scheduler: more than %d tasks\n", MAX_TASKS);
+                return -1;
+            }
+            const int id  = _num_tasks++;
+            Task&     task = _tasks[id];
+            task.name     = name;
+            task.period   = period_us;
+            task.callback = std::move(callback);
+            task.due      = now_us() + period_us;
+            task.enabled  = true;
+            push(id);
+            return id;
+        }
+
+        void setPeriod(int id, uint32_t period_us) { _tasks[id].period = period_us; }
+
+        void enable(int id, bool enabled)
+        {
+            Task& task = _tasks[id];
+            if (enabled == task.enabled)
+                return;
+            task.enabled = enabled;
+            if (enabled && !task.queued) // still queued (or running): keeps its old deadline
+            {
+                task.due = now_us() + task.period;
+                push(id);
+            }
+            // disabled tasks are dropped when they reach the top of the heap
+        }
+
+        /**
+         * @brief Run all due tasks in deadline order
+         * @return number of tasks run
+         */
+        int run()
+        {
+            int ran           = 0;
+            int num_every_run = 0;
+            int every_run[MAX_TASKS]; // period 0, queued again after this pass
+            while (_heap_size > 0)
+            {
+                const int id   = _heap[0];
+                Task&     task = _tasks[id];
+
+                if (!task.enabled)
+                {
+                    pop();
+                    continue;
+                }
+
+                const time_us now = now_us();
+                if (now < task.due)
+                    break;
+
+                pop();
+                task.queued = true; // held by run() until it is queued again, enable() must not push it
+
+                const uint32_t lateness = uint32_t(now - task.due);
+                task.callback();
+                const time_us  end     = now_us();
+                const uint32_t runtime = uint32_t(end - now);
+
+                Stats& stats = task.stats;
+                stats.runs++;
+                stats.sum_lateness_us += lateness;
+                stats.sum_runtime_us += runtime;
+                if (lateness > stats.max_lateness_us)
+                    stats.max_lateness_us = lateness;
+                if (runtime > stats.max_runtime_us)
+                    stats.max_runtime_us = runtime;
+
+                ran++;
+                if (task.period == 0)
+                {
+                    task.due                   = end;
+                    every_run[num_every_run++] = id;
+                    continue;
+                }
+
+                // keep the phase, skip whole periods that were missed
+                task.due += task.period;
+                if (task.due <= end)
+                {
+                    const time_us missed = (end - task.due) / task.period + 1;
+                    stats.overruns += uint32_t(missed);
+                    task.due += missed * task.period;
+                }
+                task.queued = false;
+                push(id);
+            }
+            for (int i = 0; i < num_every_run; i++)
+            {
+                _tasks[every_run[i]].queued = false;
+                push(every_run[i]);
+            }
+            return ran;
+        }
+
+        /**
+         * @brief Time until the next task is due (0 = due now)
+         */
+        uint32_t untilNext_us() const
+        {
+            if (_heap_size == 0)
+                return UINT32_MAX;
+            // a disabled task on top only causes an early wake-up
+            const time_us left = _tasks[_heap[0]].due - now_us();
+            return left <= 0 ? 0 : (left > UINT32_MAX ? UINT32_MAX : uint32_t(left));
+        }
+
+        /**
+         * @brief run() and then give the core away until the next deadline.
+         *
+         * On ESP32 delay() blocks the loop task in FreeRTOS, so the idle task
+         * (and automatic light sleep, if enabled) gets the time in between.
+         */
+        void runAndSleep(uint32_t max_sleep_us = 100000)
+        {
+            run();
+            uint32_t sleep_us = untilNext_us();
+            if (sleep_us > max_sleep_us)
+                sleep_us = max_sleep_us;
+            if (sleep_us >= 1000)
+                delay(sleep_us / 1000);
+            else if (sleep_us > 0)
+                delayMicroseconds(sleep_us);
+        }
+
+        const Stats& stats(int id) const { return _tasks[id].stats; }
+        void         resetStats()
+        {
+            for (int i = 0; i < _num_tasks; i++)
+                _tasks[i].stats = Stats();
+        }
+
+        void printStats() const
+        {
+            printf("%-16s %8s %8s %8s %10s %10s %10s\n", "task", "period", "runs", "overrun", "late avg", "late max", "run max");
+            for (int i = 0; i < _num_tasks; i++)
+            {
+                const Task&  t = _tasks[i];
+                const Stats& s = t.stats;
+                printf("%-16s %8u %8u %8u %10.1f %10u %10u\n",
+                       t.name,
+                       unsigned(t.period),
+                       unsigned(s.runs),
+                       unsigned(s.overruns),
+                       s.avgLateness_us(),
+                       unsigned(s.max_lateness_us),
+                       unsigned(s.max_runtime_us));
+            }
+        }
+
+        int size() const { return _num_tasks; }
+
+    private:
+        struct Task
+        {
+            const char* name    = "";
+            uint32_t    period  = 0;
+            time_us     due     = 0;
+            bool        enabled = false;
+            bool        queued  = false; // in the heap, or taken out by run() for this pass
+            Callback    callback;
+            Stats       stats;
+        };
+
+        Task _tasks[MAX_TASKS];
+        int  _num_tasks = 0;
+
+        // min-heap of task ids by due time
+        int _heap[MAX_TASKS];
+        int _heap_size = 0;
+
+        bool earlier(int a, int b) const { return _tasks[a].due < _tasks[b].due; }
+
+        // at most once in the heap, so it never holds more than MAX_TASKS
+        void push(int id)
+        {
+            if (_tasks[id].queued)
+                return;
+            _tasks[id].queued = true;
+
+            int i    = _heap_size++;
+            _heap[i] = id;
+            while (i > 0)
+            {
+                const int parent = (i - 1) / 2;
+                if (!earlier(_heap[i], _heap[parent]))
+                    break;
+                std::swap(_heap[i], _heap[parent]);
+                i = parent;
+            }
+        }
+
+        void pop()
+        {
+            _tasks[_heap[0]].queued = false;
+            _heap[0]                = _heap[--_heap_size];
+            int i    = 0;
+            while (true)
+            {
+                const int l = 2 * i + 1;
+                const int r = l + 1;
+                int       m = i;
+                if (l < _heap_size && earlier(_heap[l], _heap[m]))
+                    m = l;
+                if (r < _heap_size && earlier(_heap[r], _heap[m]))
+                    m = r;
+                if (m == i)
+                    break;
+                std::swap(_heap[i], _heap[m]);
+                i = m;
+            }
+        }
+    };
+}
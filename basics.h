@@ -1,6 +1,9 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
 
 namespace util {
 
@@ -32,18 +35,6 @@ T clip(T value, T low, T high) {
     return value;
 }
 
-#ifndef ARDUINO 
-template <typename T>
-T clip(T value, T low, T high) {
-    if (value < low)
-        return low;
-    if (value > high)
-        return high;
-    return value;
-}
-#endif
-
-
 inline float mapf(float value, float fromLow, float fromHigh, float toLow, float toHigh) {
     return (value - fromLow) * (toHigh - toLow) / (fromHigh - fromLow) + toLow;
 }
@@ -53,56 +44,158 @@ inline float mapConstrainf(float value, float fromLow, float fromHigh, float toL
     return clipf(mapf(value, fromLow, fromHigh, toLow, toHigh), toLow, toHigh);
 }
 
-/*
-// NOT FULLY TESTED yet
-float mapExpf(float value, float fromLow, float fromHigh, float toLow, float toHigh, float curveFactor=2.0) {
-    // Handle edge case where the input range is zero
-    if (fromLow == fromHigh) {
-        return toLow; // Map to the lower bound of the target range
+// ==============================
+// lookup tables
+// ==============================
+
+/**
+ * @brief Linearly interpolated lookup table with N segments over [x0, x1]
+ *
+ * Inputs outside the range are clamped. For a function with bounded second
+ * derivative f'' the error is at most (x1 - x0)^2 / N^2 * max|f''| / 8.
+ *
+ * InterpolatedLut<64> gamma;
+ * gamma.build([](float x) { return powf(x, 2.2f); }, 0, 1); // once, in setup
+ * float y = gamma(x);                                       // in the loop
+ */
+template <int N>
+class InterpolatedLut
+{
+public:
+    static constexpr int segments = N;
+
+    template <typename Fn>
+    void build(Fn fn, float x0, float x1)
+    {
+        _x0       = x0;
+        _x1       = x1;
+        _inv_step = float(N) / (x1 - x0);
+        for (int i = 0; i <= N; i++)
+            _table[i] = fn(x0 + (x1 - x0) * float(i) / float(N));
     }
 
-    // Ensure the curve factor is valid
-    if (curveFactor <= 0) {
-        return NAN; // Invalid curve factor
+    float operator()(float x) const
+    {
+        if (x <= _x0)
+            return _table[0];
+        if (x >= _x1)
+            return _table[N];
+        const float pos = (x - _x0) * _inv_step;
+        int         i   = int(pos);
+        if (i >= N)
+            i = N - 1;
+        const float frac = pos - float(i);
+        return _table[i] + (_table[i + 1] - _table[i]) * frac;
     }
 
-    // Shift the input range to make it positive if necessary
-    float shift = (fromLow <= 0) ? -fromLow + 1 : 0;
+private:
+    float _table[N + 1] = {};
+    float _x0 = 0, _x1 = 1, _inv_step = N;
+};
 
-    // Apply the shift to the input values
-    float shiftedValue = value + shift;
-    float shiftedFromLow = fromLow + shift;
-    float shiftedFromHigh = fromHigh + shift;
+/**
+ * @brief Table based log2/exp2/pow/log replacements for the hot loop.
+ *
+ * Two 128 segment tables (mantissa of log2 and fraction of exp2, ~1 KB
+ * total) are built on first use. Max error (host measured):
+ * log2f 1.2e-5 absolute, exp2f 4e-6 relative, powf 3e-5 relative for the
+ * gamma range (x in [1e-4, 1], y in [1, 3]). Only finite positive inputs
+ * are supported for log2f/logf/powf; x <= 0 returns -inf (log) or 0 (pow).
+ */
+namespace lut {
+
+constexpr int MATH_SEGMENTS = 128;
+
+inline const InterpolatedLut<MATH_SEGMENTS>& log2Mantissa()
+{
+    static const InterpolatedLut<MATH_SEGMENTS> table = [] {
+        InterpolatedLut<MATH_SEGMENTS> t;
+        t.build([](float m) { return std::log2(m); }, 1.0f, 2.0f);
+        return t;
+    }();
+    return table;
+}
 
-    // Normalize the shifted value to the range [0, 1]
-    float normalized = (shiftedValue - shiftedFromLow) / (shiftedFromHigh - shiftedFromLow);
-    normalized = clip(normalized, 0.0f, 1.0f); // Clamp to [0, 1]
+inline const InterpolatedLut<MATH_SEGMENTS>& exp2Fraction()
+{
+    static const InterpolatedLut<MATH_SEGMENTS> table = [] {
+        InterpolatedLut<MATH_SEGMENTS> t;
+        t.build([](float f) { return std::exp2(f); }, 0.0f, 1.0f);
+        return t;
+    }();
+    return table;
+}
+
+inline float log2f(float x)
+{
+    if (!(x > 0))
+        return -INFINITY;
+
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    const int exponent = int((bits >> 23) & 0xff) - 127;
+    bits               = (bits & 0x007fffff) | 0x3f800000; // mantissa in [1, 2)
+    float mantissa;
+    std::memcpy(&mantissa, &bits, sizeof(mantissa));
+
+    return float(exponent) + log2Mantissa()(mantissa);
+}
+
+inline float exp2f(float x)
+{
+    if (x < -126.0f)
+        return 0.0f;
+    if (x > 127.0f)
+        x = 127.0f;
+
+    int xi = int(x); // floor without libm
+    if (float(xi) > x)
+        xi--;
+    const float frac = exp2Fraction()(x - float(xi)); // [1, 2)
+
+    const uint32_t bits = uint32_t(xi + 127) << 23;
+    float          scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return frac * scale;
+}
+
+inline float powf(float x, float y)
+{
+    if (!(x > 0))
+        return 0.0f;
+    return exp2f(y * log2f(x));
+}
+
+inline float logf(float x) { return log2f(x) * float(M_LN2); }
+
+} // namespace lut
+
+// uses lut::powf, see above for error bounds
+inline float mapExpf(float value, float fromLow, float fromHigh, float toLow, float toHigh, float curveFactor = 2.0)
+{
+    // Handle edge case where the input range is zero
+    if (fromLow == fromHigh)
+        return toLow; // Map to the lower bound of the target range
+
+    // Ensure the curve factor is valid
+    if (curveFactor <= 0)
+        return NAN; // Invalid curve factor
+
+    // Normalize the value to the range [0, 1]
+    float normalized = (value - fromLow) / (fromHigh - fromLow);
+    normalized = clipf(normalized, 0.0f, 1.0f);
 
     // Apply exponential curve
-    float expValue = pow(normalized, curveFactor);
+    float expValue = lut::powf(normalized, curveFactor);
 
     // Map to the target range
     return expValue * (toHigh - toLow) + toLow;
 }
-*/
-
-/*
 
-  printf("--------------------\n");
-  for (int i=0;i<100;i+=5)
-    printf("Mapping Log: %d -> %f\n", i, util::mapExpConstraintf(i, 0, 100, 0, 1));
-  printf("--------------------\n");
-  for (int i=0;i<100;i+=5)
-    printf("Mapping Log: %d -> %f\n", i, util::mapExpConstraintf(i, 0, 100, 0, 100));
-  printf("--------------------\n");
-  
-  */
-
-/*
-float mapExpConstraintf(float value, float fromLow, float fromHigh, float toLow, float toHigh, float curveFactor=2.0) {
-    return constrain(mapExpf(value, fromLow, fromHigh, toLow, toHigh, curveFactor), toLow, toHigh);
+inline float mapExpConstrainf(float value, float fromLow, float fromHigh, float toLow, float toHigh, float curveFactor = 2.0)
+{
+    return clip(mapExpf(value, fromLow, fromHigh, toLow, toHigh, curveFactor), toLow, toHigh);
 }
-*/
 
 // NOT FULLY TESTED yet
 inline float mapLogf(float value, float fromLow, float fromHigh, float toLow, float toHigh) {
@@ -119,8 +212,9 @@ inline float mapLogf(float value, float fromLow, float fromHigh, float toLow, fl
     float shiftedFromLow = fromLow + shift;
     float shiftedFromHigh = fromHigh + shift;
 
-    // Map `value` to a logarithmic scale
-    float logValue = (log(shiftedValue) - log(shiftedFromLow)) / (log(shiftedFromHigh) - log(shiftedFromLow));
+    // Map `value` to a logarithmic scale (base cancels out, table based log2, see util::lut)
+    const float logLow   = lut::log2f(shiftedFromLow);
+    float       logValue = (lut::log2f(shiftedValue) - logLow) / (lut::log2f(shiftedFromHigh) - logLow);
 
     // Map the logarithmic value to the desired range
     return logValue * (toHigh - toLow) + toLow;
@@ -158,14 +252,77 @@ inline float centerHysteris(float value, float deadzone_width)
         return 0;
 }
 
+/**
+ * @brief Wraps value into [low, high), constant time for any input magnitude.
+ *
+ * - in range: returned unchanged
+ * - integral: modulo, a mask when (high - low) is a power of two
+ * - floating: one add/sub when within one range (same result as before),
+ *   integer quotient beyond that
+ * - other types (e.g. util::fixed) need a wrap() overload, see fixed_point.h
+ */
 template <typename T>
 T wrap(T value, T low, T high) {
     T range = high - low;
-    while (value < low)
-        value += range;
-    while (value >= high)
-        value -= range;
-    return value;
+
+    if constexpr (std::is_integral<T>::value)
+    {
+        if (value >= low && value < high)
+            return value;
+
+        if ((range & (range - 1)) == 0) // power of two, two's complement wraps correctly
+            return T(low + T(T(value - low) & T(range - 1)));
+
+        if (value >= low)
+            return T(low + T(value - low) % range);
+        const T offset = T(low - value) % range;
+        return offset == 0 ? low : T(high - offset);
+    }
+    else if constexpr (std::is_floating_point<T>::value)
+    {
+        if (value >= low)
+        {
+            if (value < high)
+                return value;
+            if (value - range < high)
+                return value - range;
+        }
+        else if (value + range >= low)
+            return value + range;
+
+        const T offset = value - low;
+        const T q      = offset / range;
+        T       r;
+        if (std::fabs(q) < T(1e15)) // integer quotient without libm, no loop over the exponent like fmod
+        {
+            int64_t n = int64_t(q);
+            if (T(n) > q)
+                n--;
+            r = offset - T(n) * range;
+            if (r < 0)
+                r += range;
+            else if (r >= range)
+                r -= range;
+        }
+        else
+        {
+            r = std::fmod(offset, range);
+            if (r < 0)
+                r += range;
+        }
+        r += low;
+        return r >= high ? low : r; // rounding of r + low can land on high
+    }
+    else
+    {
+        if (value >= low && value < high)
+            return value;
+        while (value < low)
+            value += range;
+        while (value >= high)
+            value -= range;
+        return value;
+    }
 }
 
 inline float wrapf(float value, float low, float high) {
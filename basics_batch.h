@@ -0,0 +1,191 @@
+#pragma once
+
+/**
+ * @file basics_batch.h
+ * @brief Buffer versions of the util:: mapping helpers in basics.h
+ *
+ * Same math and operation order as the scalar functions, so every element
+ * equals the result of the scalar version (for non-NaN input).
+ * mapf / mapConstrainf / clipf / normf use SSE2 (x86) or NEON (AArch64)
+ * kernels when available, everything else (and MCUs) uses plain loops.
+ * `in` and `out` may be the same buffer.
+ *
+ * Usage:
+ *
+ * float raw[32], norm[32];
+ * util::mapConstrainf(raw, norm, 32, 0, 4095, 0, 1);
+ * util::mapConstrainf(std::span<const float>(raw), std::span<float>(norm), 0, 4095, 0, 1); // C++20
+ */
+
+#include <cstddef>
+#include "basics.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define UTIL_BATCH_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define UTIL_BATCH_NEON 1
+#endif
+
+#if __has_include(<span>)
+#include <span>
+#endif
+
+namespace util {
+
+namespace batch {
+
+// MAP:  v = (v - fromLow) * dTo / dFrom + toLow
+// CLIP: v = clipf(v, low, high)
+template <bool MAP, bool CLIP>
+inline void linear(const float* in,
+                   float*       out,
+                   size_t       n,
+                   float        fromLow,
+                   float        dFrom,
+                   float        toLow,
+                   float        dTo,
+                   float        low,
+                   float        high)
+{
+    size_t i = 0;
+
+#if UTIL_BATCH_SSE2
+    const __m128 v_from_low = _mm_set1_ps(fromLow);
+    const __m128 v_d_from   = _mm_set1_ps(dFrom);
+    const __m128 v_to_low   = _mm_set1_ps(toLow);
+    const __m128 v_d_to     = _mm_set1_ps(dTo);
+    const __m128 v_low      = _mm_set1_ps(low);
+    const __m128 v_high     = _mm_set1_ps(high);
+    for (; i + 4 <= n; i += 4)
+    {
+        __m128 v = _mm_loadu_ps(in + i);
+        if (MAP)
+            v = _mm_add_ps(_mm_div_ps(_mm_mul_ps(_mm_sub_ps(v, v_from_low), v_d_to), v_d_from), v_to_low);
+        if (CLIP)
+        {
+            // same precedence as clipf: "< low" wins over "> high"
+            const __m128 lt = _mm_cmplt_ps(v, v_low);
+            const __m128 gt = _mm_cmpgt_ps(v, v_high);
+            v = _mm_or_ps(_mm_and_ps(gt, v_high), _mm_andnot_ps(gt, v));
+            v = _mm_or_ps(_mm_and_ps(lt, v_low), _mm_andnot_ps(lt, v));
+        }
+        _mm_storeu_ps(out + i, v);
+    }
+#elif UTIL_BATCH_NEON
+    const float32x4_t v_from_low = vdupq_n_f32(fromLow);
+    const float32x4_t v_d_from   = vdupq_n_f32(dFrom);
+    const float32x4_t v_to_low   = vdupq_n_f32(toLow);
+    const float32x4_t v_d_to     = vdupq_n_f32(dTo);
+    const float32x4_t v_low      = vdupq_n_f32(low);
+    const float32x4_t v_high     = vdupq_n_f32(high);
+    for (; i + 4 <= n; i += 4)
+    {
+        float32x4_t v = vld1q_f32(in + i);
+        if (MAP)
+            v = vaddq_f32(vdivq_f32(vmulq_f32(vsubq_f32(v, v_from_low), v_d_to), v_d_from), v_to_low);
+        if (CLIP)
+        {
+            const uint32x4_t lt = vcltq_f32(v, v_low);
+            const uint32x4_t gt = vcgtq_f32(v, v_high);
+            v = vbslq_f32(gt, v_high, v);
+            v = vbslq_f32(lt, v_low, v);
+        }
+        vst1q_f32(out + i, v);
+    }
+#endif
+
+    for (; i < n; i++)
+    {
+        const float v = MAP ? (in[i] - fromLow) * dTo / dFrom + toLow : in[i];
+        out[i]        = CLIP ? clipf(v, low, high) : v;
+    }
+}
+
+} // namespace batch
+
+inline void mapf(const float* in, float* out, size_t n, float fromLow, float fromHigh, float toLow, float toHigh)
+{
+    batch::linear<true, false>(in, out, n, fromLow, fromHigh - fromLow, toLow, toHigh - toLow, 0, 0);
+}
+
+inline void mapConstrainf(const float* in, float* out, size_t n, float fromLow, float fromHigh, float toLow, float toHigh)
+{
+    batch::linear<true, true>(in, out, n, fromLow, fromHigh - fromLow, toLow, toHigh - toLow, toLow, toHigh);
+}
+
+inline void clipf(const float* in, float* out, size_t n, float low, float high)
+{
+    batch::linear<false, true>(in, out, n, 0, 1, 0, 1, low, high);
+}
+
+inline void normf(const float* in, float* out, size_t n, float low, float high)
+{
+    // == clipf((v - low) / (high - low), 0, 1)
+    batch::linear<true, true>(in, out, n, low, high - low, 0.0f, 1.0f, 0.0f, 1.0f);
+}
+
+inline void wrapf(const float* in, float* out, size_t n, float low, float high)
+{
+    for (size_t i = 0; i < n; i++)
+        out[i] = wrapf(in[i], low, high);
+}
+
+inline void centerHysteris(const float* in, float* out, size_t n, float deadzone_width)
+{
+    for (size_t i = 0; i < n; i++)
+        out[i] = centerHysteris(in[i], deadzone_width);
+}
+
+inline void convert_zero_zone(const float* in, float* out, size_t n, float zero_zone)
+{
+    for (size_t i = 0; i < n; i++)
+        out[i] = convert_zero_zone(in[i], zero_zone);
+}
+
+#if defined(__cpp_lib_span)
+// span overloads, n = min(in.size(), out.size())
+
+inline size_t batchSize(std::span<const float> in, std::span<float> out)
+{
+    return in.size() < out.size() ? in.size() : out.size();
+}
+
+inline void mapf(std::span<const float> in, std::span<float> out, float fromLow, float fromHigh, float toLow, float toHigh)
+{
+    mapf(in.data(), out.data(), batchSize(in, out), fromLow, fromHigh, toLow, toHigh);
+}
+
+inline void mapConstrainf(std::span<const float> in, std::span<float> out, float fromLow, float fromHigh, float toLow, float toHigh)
+{
+    mapConstrainf(in.data(), out.data(), batchSize(in, out), fromLow, fromHigh, toLow, toHigh);
+}
+
+inline void clipf(std::span<const float> in, std::span<float> out, float low, float high)
+{
+    clipf(in.data(), out.data(), batchSize(in, out), low, high);
+}
+
+inline void normf(std::span<const float> in, std::span<float> out, float low, float high)
+{
+    normf(in.data(), out.data(), batchSize(in, out), low, high);
+}
+
+inline void wrapf(std::span<const float> in, std::span<float> out, float low, float high)
+{
+    wrapf(in.data(), out.data(), batchSize(in, out), low, high);
+}
+
+inline void centerHysteris(std::span<const float> in, std::span<float> out, float deadzone_width)
+{
+    centerHysteris(in.data(), out.data(), batchSize(in, out), deadzone_width);
+}
+
+inline void convert_zero_zone(std::span<const float> in, std::span<float> out, float zero_zone)
+{
+    convert_zero_zone(in.data(), out.data(), batchSize(in, out), zero_zone);
+}
+#endif
+
+} // namespace util
@@ -0,0 +1,199 @@
+#pragma once
+
+/**
+ * @file benchmark.h
+ * @brief Minimal micro-benchmark harness (ns/call and cycles/call).
+ *
+ * Runs on target and on the host shim (see host/readme.md). On the host the
+ * wall clock is used for measuring, the virtual clock stays untouched so the
+ * code under test sees deterministic time.
+ *
+ * Usage:
+ *
+ * util::bench::Runner bench;
+ * bench.run("pid.process", [&] { out = pid.process(in); });
+ * bench.print();
+ * bench.saveBaseline("bench_baseline.txt");   // once, on a known good commit
+ * bool ok = bench.checkBaseline("bench_baseline.txt", 0.10f); // +10% allowed
+ */
+
+#include <Arduino.h>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef ARDUINO_HOST
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#endif
+
+namespace util {
+namespace bench {
+
+// prevents the compiler from optimizing away results of the measured code
+template <typename T>
+inline void doNotOptimize(T const& value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile T sink;
+    sink = value;
+#endif
+}
+
+inline uint64_t nowNs()
+{
+#ifdef ARDUINO_HOST
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+#else
+    return uint64_t(micros()) * 1000;
+#endif
+}
+
+inline uint64_t nowCycles()
+{
+#if defined(ARDUINO_HOST) && (defined(__x86_64__) || defined(__i386__))
+    return __rdtsc();
+#elif defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    return ESP.getCycleCount(); // 32 bit, fine for single runs < ~10 s
+#else
+    return 0;
+#endif
+}
+
+struct Result
+{
+    char     name[40];
+    uint32_t iterations;
+    float    ns_per_call;
+    float    cycles_per_call;
+};
+
+class Runner
+{
+public:
+    explicit Runner(uint32_t iterations = 100000, uint32_t seed = 1234)
+        : _iterations(iterations), _seed(seed)
+    {
+    }
+
+    /**
+     * @brief Measure fn, best of `repeats` batches of `iterations` calls
+     * @return ns per call
+     */
+    template <typename Fn>
+    float run(const char* name, Fn&& fn, int repeats = 5)
+    {
+        randomSeed(_seed); // same input sequence for every benchmark and commit
+
+        for (uint32_t i = 0; i < _iterations / 10 + 1; i++) // warm up
+            fn();
+
+        float best_ns     = 1e30f;
+        float best_cycles = 0;
+        for (int r = 0; r < repeats; r++)
+        {
+            const uint64_t t0 = nowNs();
+            const uint64_t c0 = nowCycles();
+            for (uint32_t i = 0; i < _iterations; i++)
+                fn();
+            const uint64_t c1 = nowCycles();
+            const uint64_t t1 = nowNs();
+
+            const float ns = float(t1 - t0) / float(_iterations);
+            if (ns < best_ns)
+            {
+                best_ns     = ns;
+                best_cycles = float(c1 - c0) / float(_iterations);
+            }
+        }
+
+        Result result;
+        std::snprintf(result.name, sizeof(result.name), "%s", name);
+        result.iterations      = _iterations;
+        result.ns_per_call     = best_ns;
+        result.cycles_per_call = best_cycles;
+        _results.push_back(result);
+        return best_ns;
+    }
+
+    void print() const
+    {
+        printf("%-40s %12s %12s\n", "benchmark", "ns/call", "cycles/call");
+        for (const auto& r : _results)
+            printf("%-40s %12.2f %12.1f\n", r.name, r.ns_per_call, r.cycles_per_call);
+    }
+
+    /**
+     * @brief Write "name ns_per_call" lines
+     */
+    bool saveBaseline(const char* path) const
+    {
+        FILE* file = std::fopen(path, "w");
+        if (!file)
+        {
+            printf("ERROR in bench::saveBaseline: cannot open %s\n", path);
+            return false;
+        }
+        for (const auto& r : _results)
+            std::fprintf(file, "%s %f\n", r.name, r.ns_per_call);
+        std::fclose(file);
+        return true;
+    }
+
+    /**
+     * @brief Compare against a stored baseline
+     * @param tolerance allowed relative slowdown (0.1 = 10%)
+     * @return false if any benchmark is slower than baseline * (1 + tolerance)
+     */
+    bool checkBaseline(const char* path, float tolerance = 0.1f) const
+    {
+        FILE* file = std::fopen(path, "r");
+        if (!file)
+        {
+            printf("ERROR in bench::checkBaseline: cannot open %s\n", path);
+            return false;
+        }
+
+        bool  ok = true;
+        char  name[64];
+        float baseline_ns;
+        while (std::fscanf(file, "%63s %f", name, &baseline_ns) == 2)
+        {
+            for (const auto& r : _results)
+            {
+                if (std::strcmp(r.name, name) != 0)
+                    continue;
+
+                const float limit = baseline_ns * (1.0f + tolerance);
+                if (r.ns_per_call > limit)
+                {
+                    printf("REGRESSION %s: %.2f ns/call > baseline %.2f ns/call (+%.0f%%)\n",
+                           name,
+                           r.ns_per_call,
+                           baseline_ns,
+                           (r.ns_per_call / baseline_ns - 1.0f) * 100.0f);
+                    ok = false;
+                }
+            }
+        }
+        std::fclose(file);
+        return ok;
+    }
+
+    const std::vector<Result>& results() const { return _results; }
+
+private:
+    uint32_t            _iterations;
+    uint32_t            _seed;
+    std::vector<Result> _results;
+};
+
+} // namespace bench
+} // namespace util
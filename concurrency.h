@@ -0,0 +1,259 @@
+#pragma once
+
+/**
+ * @file concurrency.h
+ * @brief Lock-free primitives for handing data between two tasks/cores
+ *
+ * Fixed capacity, no heap, header only. Works with FreeRTOS tasks on
+ * ESP32 and with threads on the host build.
+ *
+ * - SpscQueue:    FIFO, one producer, one consumer (commands, events)
+ * - TripleBuffer: latest value, one writer, one reader, never blocks either
+ * - SeqLock:      latest value of a small struct, one writer, many readers
+ *
+ * E.g. MQTT::handleCallback / WebSocket callbacks write the new setpoint,
+ * the control loop reads the latest one, even when they run on other cores.
+ *
+ * Usage:
+ *
+ * util::SpscQueue<Command, 16> commands; // one producer, one consumer
+ *
+ * commands.push(cmd);           // network task
+ * while (commands.pop(cmd))     // control task
+ *   apply(cmd);
+ *
+ * util::TripleBuffer<Setpoint> setpoint;
+ * setpoint.write({0.5f, 2.0f}); // callback
+ * if (setpoint.update())        // control loop, true if there is a new one
+ *   pid.setTarget(setpoint.read().position);
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace util {
+
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+static constexpr size_t CACHE_LINE = 32;
+#else
+static constexpr size_t CACHE_LINE = 64;
+#endif
+
+/**
+ * @brief Wait-free single producer / single consumer ring buffer
+ *
+ * push() only ever called from one task, pop() only from one (other) task.
+ * Each side keeps a cached copy of the other side's index, so the shared
+ * cache line is only read when the queue looks full/empty.
+ *
+ * @tparam CAPACITY power of two
+ */
+template <typename T, size_t CAPACITY>
+class SpscQueue
+{
+    static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "SpscQueue<T>: T must be trivially copyable");
+
+public:
+    static constexpr size_t capacity() { return CAPACITY; }
+
+    // producer side, false if full
+    bool push(const T& value)
+    {
+        const uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head_cache == CAPACITY)
+        {
+            _head_cache = _head.load(std::memory_order_acquire);
+            if (tail - _head_cache == CAPACITY)
+                return false;
+        }
+        _buffer[tail & MASK] = value;
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side, false if empty
+    bool pop(T& value)
+    {
+        const uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail_cache)
+        {
+            _tail_cache = _tail.load(std::memory_order_acquire);
+            if (head == _tail_cache)
+                return false;
+        }
+        value = _buffer[head & MASK];
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side, nullptr if empty, call consume() when done
+    const T* front()
+    {
+        const uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail_cache)
+        {
+            _tail_cache = _tail.load(std::memory_order_acquire);
+            if (head == _tail_cache)
+                return nullptr;
+        }
+        return &_buffer[head & MASK];
+    }
+
+    void consume() { _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+    // approximate when called while the other side is active
+    size_t size() const
+    {
+        return _tail.load(std::memory_order_acquire) - _head.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+
+private:
+    static constexpr uint32_t MASK = CAPACITY - 1;
+
+    // producer
+    alignas(CACHE_LINE) std::atomic<uint32_t> _tail{0};
+    uint32_t _head_cache = 0;
+
+    // consumer
+    alignas(CACHE_LINE) std::atomic<uint32_t> _head{0};
+    uint32_t _tail_cache = 0;
+
+    alignas(CACHE_LINE) T _buffer[CAPACITY];
+};
+
+/**
+ * @brief Wait-free "latest value" handoff between one writer and one reader
+ *
+ * Three copies of T: the writer fills its private one and swaps it with the
+ * shared middle one, the reader swaps its private one with the middle one
+ * if it is newer. Neither side ever waits, intermediate values may be
+ * skipped. Each copy sits on its own cache line.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+    explicit TripleBuffer(const T& initial)
+    {
+        for (auto& slot : _slots)
+            slot.value = initial;
+    }
+
+    // writer side: fill writeBuffer() in place, then publish()
+    T&   writeBuffer() { return _slots[_write].value; }
+    void publish() { _write = _middle.exchange(uint8_t(_write | DIRTY), std::memory_order_acq_rel) & INDEX; }
+
+    void write(const T& value)
+    {
+        writeBuffer() = value;
+        publish();
+    }
+
+    // reader side: fetch the latest published value, false if nothing new
+    bool update()
+    {
+        if (!(_middle.load(std::memory_order_relaxed) & DIRTY))
+            return false;
+        _read = _middle.exchange(_read, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    const T& read() const { return _slots[_read].value; }
+
+    // update() + read()
+    bool read(T& value)
+    {
+        const bool fresh = update();
+        value            = read();
+        return fresh;
+    }
+
+private:
+    static constexpr uint8_t INDEX = 0x03;
+    static constexpr uint8_t DIRTY = 0x04;
+
+    struct alignas(CACHE_LINE) Slot
+    {
+        T value{};
+    };
+
+    Slot                 _slots[3];
+    std::atomic<uint8_t> _middle{1};
+    uint8_t              _write = 0; // writer only
+    uint8_t              _read  = 2; // reader only
+};
+
+/**
+ * @brief Sequence lock for small trivially copyable structs
+ *
+ * One writer, any number of readers. store() never waits, a reader retries
+ * if the writer was active during its copy. Data is copied word by word
+ * through atomics, so there is no data race in the C++ sense.
+ * Keep T small (a few words), readers spin while it is written.
+ */
+template <typename T>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock<T>: T must be trivially copyable");
+
+public:
+    SeqLock() { store(T{}); }
+    explicit SeqLock(const T& initial) { store(initial); }
+
+    // writer side (single writer)
+    void store(const T& value)
+    {
+        uint32_t words[WORDS] = {};
+        std::memcpy(words, &value, sizeof(T));
+
+        const uint32_t seq = _seq.load(std::memory_order_relaxed);
+        _seq.store(seq + 1, std::memory_order_relaxed); // odd: write in progress
+        // release: a reader that sees any new word also sees the odd sequence
+        for (size_t i = 0; i < WORDS; i++)
+            _words[i].store(words[i], std::memory_order_release);
+        _seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // reader side, false if a write was in progress (value is then unchanged)
+    bool tryLoad(T& value) const
+    {
+        const uint32_t seq = _seq.load(std::memory_order_acquire);
+        if (seq & 1)
+            return false;
+
+        uint32_t words[WORDS];
+        for (size_t i = 0; i < WORDS; i++)
+            words[i] = _words[i].load(std::memory_order_acquire);
+        if (_seq.load(std::memory_order_relaxed) != seq)
+            return false;
+
+        std::memcpy(&value, words, sizeof(T));
+        return true;
+    }
+
+    T load() const
+    {
+        T value;
+        while (!tryLoad(value))
+        {
+        }
+        return value;
+    }
+
+    // changes with every store(), readers can use it to detect new values
+    uint32_t version() const { return _seq.load(std::memory_order_acquire) >> 1; }
+
+private:
+    static constexpr size_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> _seq{0};
+    std::atomic<uint32_t> _words[WORDS];
+};
+
+} // namespace util
@@ -0,0 +1,284 @@
+#pragma once
+
+/**
+ * @file dual_core.h
+ * @brief Control on one core, networking on the other (ESP32 FreeRTOS)
+ *
+ * The real-time parts (PID, util::led::Driver, H_Bridge_Driver,
+ * Stepper_Driver) run in a periodic task pinned to CORE_CONTROL, the
+ * networking stack (MQTT, SocketServer, ManagedServer) in a task pinned to
+ * CORE_COMM, next to the WiFi/lwIP tasks. A blocking reconnect on the comm
+ * side no longer stalls the motors. The two sides only talk through the
+ * lock-free SPSC queues: `commands` (comm -> control) and `telemetry`
+ * (control -> comm), so COMMAND/TELEMETRY must be trivially copyable.
+ *
+ * Host build (ARDUINO_HOST): tasks are std::threads (pthreads, add -pthread)
+ * that poll the virtual clock, so tests step time with host::clock as usual.
+ * Without FreeRTOS (ESP8266) both sides run from loop() instead.
+ *
+ * Usage:
+ *
+ * struct Command { float target; };
+ * struct Telemetry { float position; float output; };
+ * util::rtos::DualCore<Command, Telemetry> cores;
+ *
+ * void setup() {
+ *   cores.begin(
+ *       [] { // control, every 1 ms
+ *         Command cmd;
+ *         while (cores.commands.pop(cmd)) pid.setTarget(cmd.target);
+ *         const float out = pid.process(readPosition());
+ *         motor.set(out);
+ *         motor.update();
+ *         led.update();
+ *         cores.telemetry.push({pid._input, out});
+ *       },
+ *       1000,
+ *       [] { // comm
+ *         mqtt.loop();
+ *         server.loop();
+ *         Telemetry t;
+ *         while (cores.telemetry.pop(t)) mqtt.publish("position", String(t.position));
+ *       });
+ * }
+ *
+ * void loop() {
+ *   cores.loop(); // only does something without FreeRTOS
+ * }
+ */
+
+#include <Arduino.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+
+#include "arduino_time.h"
+#include "concurrency.h"
+
+#if defined(ARDUINO_HOST)
+#include <chrono>
+#include <thread>
+#define UTIL_RTOS_TASKS 1
+#elif defined(ARDUINO_ARCH_ESP32)
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#define UTIL_RTOS_TASKS 1
+#else
+#define UTIL_RTOS_TASKS 0
+#endif
+
+namespace util {
+namespace rtos {
+
+#if defined(CONFIG_FREERTOS_UNICORE) && CONFIG_FREERTOS_UNICORE
+static constexpr int CORE_COMM    = 0;
+static constexpr int CORE_CONTROL = 0; // single core chips (C3, S2, ...): priorities only
+#else
+static constexpr int CORE_COMM    = 0; // PRO_CPU, WiFi/lwIP live here
+static constexpr int CORE_CONTROL = 1; // APP_CPU
+#endif
+
+/**
+ * @brief Runs a callback every period_us in its own task pinned to a core
+ *
+ * Phase locked to the first deadline (util::Deadline), missed periods are
+ * skipped. period_us = 0 runs as often as possible but still yields once
+ * per FreeRTOS tick so the idle task (watchdog) is served.
+ */
+class PeriodicTask
+{
+public:
+    using Callback = std::function<void()>;
+
+    PeriodicTask() = default;
+    PeriodicTask(const PeriodicTask&) = delete;
+    PeriodicTask& operator=(const PeriodicTask&) = delete;
+    ~PeriodicTask() { stop(); }
+
+    bool start(const char* name, int core, uint32_t period_us, Callback callback, int priority = 1, uint32_t stack = 4096)
+    {
+        if (_running)
+        {
+            printf("ERROR in util::rtos::PeriodicTask: %s already running\n", name);
+            return false;
+        }
+        _name      = name;
+        _period_us = period_us;
+        _callback  = std::move(callback);
+        _running   = true;
+        _stopped   = false; // before the task exists: stop() must wait for it even if it never ran
+
+#if defined(ARDUINO_HOST)
+        (void)core, (void)priority, (void)stack;
+        _thread = std::thread([this] { body(); });
+        return true;
+#elif UTIL_RTOS_TASKS
+        if (xTaskCreatePinnedToCore(entry, name, stack, this, priority, &_handle, core) != pdPASS)
+        {
+            printf("ERROR in util::rtos::PeriodicTask: cannot create %s\n", name);
+            _running = false;
+            _stopped = true;
+            return false;
+        }
+        return true;
+#else
+        (void)core, (void)priority, (void)stack;
+        _running = false;
+        _stopped = true;
+        return false;
+#endif
+    }
+
+    // blocks until the task has left its loop
+    void stop()
+    {
+        if (!_running)
+            return;
+        _running = false;
+#if defined(ARDUINO_HOST)
+        if (_thread.joinable())
+            _thread.join();
+#elif UTIL_RTOS_TASKS
+        while (!_stopped)
+            vTaskDelay(1);
+#endif
+    }
+
+    // one iteration without a task (fallback when there is no RTOS)
+    void poll()
+    {
+        if (_deadline.poll(_period_us))
+            runOnce();
+    }
+
+    bool        running() const { return _running; }
+    const char* name() const { return _name; }
+    uint32_t    runs() const { return _runs; }
+    uint32_t    maxRuntime_us() const { return _max_runtime_us; }
+
+private:
+    const char*       _name      = "";
+    uint32_t          _period_us = 0;
+    Callback          _callback;
+    util::Deadline    _deadline;
+    std::atomic<bool> _running{false};
+    std::atomic<bool> _stopped{true};
+
+    std::atomic<uint32_t> _runs{0};
+    std::atomic<uint32_t> _max_runtime_us{0};
+
+#if defined(ARDUINO_HOST)
+    std::thread _thread;
+#elif UTIL_RTOS_TASKS
+    TaskHandle_t _handle        = nullptr;
+    time_us      _last_block_us = 0;
+
+    static void entry(void* self)
+    {
+        static_cast<PeriodicTask*>(self)->body();
+        vTaskDelete(nullptr);
+    }
+#endif
+
+    void runOnce()
+    {
+        const time_us start = now_us();
+        _callback();
+        const uint32_t runtime = uint32_t(now_us() - start);
+        if (runtime > _max_runtime_us)
+            _max_runtime_us = runtime;
+        _runs++;
+    }
+
+    void body()
+    {
+        _deadline = util::Deadline();
+        while (_running)
+        {
+            poll();
+            sleep(_deadline.remaining_us());
+        }
+        _stopped = true;
+    }
+
+    void sleep(time_us us)
+    {
+#if defined(ARDUINO_HOST)
+        // virtual time only moves when the test moves it, so just poll it
+        (void)us;
+        std::this_thread::sleep_for(std::chrono::microseconds(50));
+#elif UTIL_RTOS_TASKS
+        static constexpr time_us TICK_US = portTICK_PERIOD_MS * 1000;
+        if (us >= TICK_US)
+            vTaskDelay(TickType_t(us / TICK_US));
+        else if (now_us() - _last_block_us >= TICK_US)
+            vTaskDelay(1); // sub-tick periods spin, but let the idle task run once per tick
+        else
+            return;
+        _last_block_us = now_us();
+#else
+        (void)us;
+#endif
+    }
+};
+
+/**
+ * @brief Control task + comm task with SPSC queues in between
+ */
+template <typename COMMAND, typename TELEMETRY, size_t QUEUE_SIZE = 16>
+class DualCore
+{
+public:
+    SpscQueue<COMMAND, QUEUE_SIZE>   commands;  // comm -> control
+    SpscQueue<TELEMETRY, QUEUE_SIZE> telemetry; // control -> comm
+
+    /**
+     * @param control real-time part, runs every control_period_us on CORE_CONTROL
+     * @param comm networking part, runs every comm_period_us on CORE_COMM (may block)
+     */
+    void begin(PeriodicTask::Callback control,
+               uint32_t               control_period_us,
+               PeriodicTask::Callback comm,
+               uint32_t               comm_period_us = 1000)
+    {
+        const bool control_ok = _control.start("control", CORE_CONTROL, control_period_us, std::move(control), CONTROL_PRIORITY);
+        const bool comm_ok    = _comm.start("comm", CORE_COMM, comm_period_us, std::move(comm), COMM_PRIORITY, 8192);
+        _threaded             = control_ok && comm_ok;
+        if (!control_ok && !comm_ok)
+            printf("util::rtos::DualCore: no FreeRTOS, running both from loop()\n");
+        else if (!_threaded)
+            printf("util::rtos::DualCore: %s task not started, running it from loop()\n", control_ok ? "comm" : "control");
+    }
+
+    // only needed if a task could not be started (no FreeRTOS), that side then
+    // runs from the Arduino loop, a task that did start is never polled as well
+    void loop()
+    {
+        if (_threaded)
+            return;
+        if (!_control.running())
+            _control.poll();
+        if (!_comm.running())
+            _comm.poll();
+    }
+
+    void end()
+    {
+        _control.stop();
+        _comm.stop();
+    }
+
+    PeriodicTask& controlTask() { return _control; }
+    PeriodicTask& commTask() { return _comm; }
+
+private:
+    static constexpr int CONTROL_PRIORITY = 5; // above loopTask (1), below WiFi (18+)
+    static constexpr int COMM_PRIORITY    = 1;
+
+    PeriodicTask _control;
+    PeriodicTask _comm;
+    bool         _threaded = false;
+};
+
+} // namespace rtos
+} // namespace util
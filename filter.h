@@ -1,11 +1,14 @@
 #pragma once
-#include <Arduino.h>
+#include <cmath>
+#include <cstdlib>
+
+#include "basics.h"
 
 static void simpleFilterf(float &value, float target, float filterFactor = 0.2, float lastStep = 0.01)
 {
     if (value == target)
         return;
-    else if (abs(value - target) <= lastStep)
+    else if (std::fabs(value - target) <= lastStep)
         value = target;
     else
         value = value * (1.0 - filterFactor) + target * filterFactor; // TODO maybe better implementation for this
@@ -15,7 +18,7 @@ static int simpleFilter(int &value, int target, float filterFactor)
 {
     int maxStep = float(1.0 / filterFactor) + 1;
     
-    if (abs(value - target) <= maxStep)
+    if (std::abs(value - target) <= maxStep)
         value = target;
     else
         value = value * (1.0 - filterFactor) + target * filterFactor;
@@ -27,7 +30,7 @@ static void simpleFilterWrapf(float &value, float target, float filterFactor = 0
 {
     if (value == target)
         return;
-    else if (abs(value - target) <= lastStep)
+    else if (std::fabs(value - target) <= lastStep)
         value = target;
     else
     {
@@ -38,4 +41,449 @@ static void simpleFilterWrapf(float &value, float target, float filterFactor = 0
             diff += 1;
         value += diff * filterFactor;
     }
-}
\ No newline at end of file
+}
+
+// ==============================
+// frame-rate independent variants
+// ==============================
+//
+// Same behaviour as simpleFilterf/simpleFilterWrapf, but the step is derived
+// from the elapsed time and a time constant (factor = 1 - exp(-dt / tau)),
+// so a step decays to exp(-t / tau) after t however the time is split into
+// calls: 100 ticks of 3 ms and one stalled 300 ms tick end at the same value.
+//
+// simpleFilterDtf(current, target, since_last_call_ms, 150);
+
+/**
+ * @brief Time constant that matches a per-call filterFactor at a call period
+ * e.g. filterFactorToTimeConstant(0.1, 3) == 28.5 ms, exact inverse of filterFactorFromTime
+ */
+inline float filterFactorToTimeConstant(float filterFactor, float period_ms)
+{
+    if (filterFactor >= 1.0f)
+        return 0.0f;
+    if (filterFactor <= 0.0f)
+        return INFINITY;
+    return -period_ms / std::log(1.0f - filterFactor);
+}
+
+// 1 - exp(-dt / tau), table based exp2 (util::lut), no libm call per tick
+inline float filterFactorFromTime(float dt_ms, float time_constant_ms)
+{
+    if (!(time_constant_ms > 0))
+        return 1.0f;
+    if (!(dt_ms > 0))
+        return 0.0f;
+    const float x = dt_ms / time_constant_ms;
+    if (x < 0.05f)
+        return x * (1.0f - x * (0.5f - x * (1.0f / 6.0f))); // series (< 3e-7), 1 - exp2f() would cancel
+    return 1.0f - util::lut::exp2f(-x * float(M_LOG2E));
+}
+
+inline void simpleFilterDtf(float &value, float target, float dt_ms, float time_constant_ms, float lastStep = 0.01)
+{
+    simpleFilterf(value, target, filterFactorFromTime(dt_ms, time_constant_ms), lastStep);
+}
+
+inline void simpleFilterWrapDtf(float &value, float target, float dt_ms, float time_constant_ms, float lastStep = 0.01)
+{
+    simpleFilterWrapf(value, target, filterFactorFromTime(dt_ms, time_constant_ms), lastStep);
+}
+
+// ==============================
+// filter library
+// ==============================
+//
+// All filters are allocation-free and templated on the sample type
+// (float or util::fixed from fixed_point.h). Common interface:
+//
+//   T    process(T x, T dt_s); // dt in seconds since the last sample
+//   T    value() const;        // last output
+//   void reset(T value = 0);
+//
+// OnePole and OneEuro use the exact factor 1 - exp(-dt / tau) (see
+// filterFactorFromTime), so their smoothing does not depend on how often they
+// are called. Biquad is designed for one sample rate, process(x, dt)
+// re-derives it when dt drifts by more than 1%, so it only approximates that
+// with jittery calls. RunningMedian and MovingAverage work on sample counts
+// and ignore dt.
+//
+// Usage:
+//
+// util::filter::OnePole<> knob(0.05);     // 50 ms time constant
+// util::filter::OneEuro<> jitter(1.0, 0.01);
+//
+// void loop() {
+//   static lpsd_ms since;
+//   float dt = since / 1000.0f; since = 0;
+//   float smooth = knob.process(analogRead(A0) / 4095.0f, dt);
+// }
+
+namespace util {
+namespace filter {
+
+namespace detail {
+
+template <typename T>
+constexpr T absT(T x)
+{
+    return x < T(0) ? -x : x;
+}
+
+constexpr float TWO_PI_F = 6.283185307179586f;
+
+// 1 - exp(-dt / tau), computed in float (also for fixed-point T)
+template <typename T>
+T smoothingFactor(T dt_s, T tau_s)
+{
+    return T(filterFactorFromTime(float(dt_s), float(tau_s)));
+}
+
+} // namespace detail
+
+/**
+ * @brief First order low-pass with a time constant (RC filter)
+ *
+ * alpha = 1 - exp(-dt / tau): exact discretisation of the RC filter for any
+ * dt (a held input decays the same whether dt comes in one call or many),
+ * exp from the util::lut table, no libm call per sample.
+ */
+template <typename T = float>
+class OnePole
+{
+public:
+    explicit OnePole(T time_constant_s = T(0.1f)) : _tau(time_constant_s) {}
+
+    void setTimeConstant(T time_constant_s) { _tau = time_constant_s; }
+    void setCutoff(float cutoff_hz) { _tau = T(1.0f / (detail::TWO_PI_F * cutoff_hz)); }
+
+    T process(T x, T dt_s)
+    {
+        if (_first)
+        {
+            _first = false;
+            _y     = x;
+            return _y;
+        }
+        const T alpha = detail::smoothingFactor(dt_s, _tau);
+        _y += (x - _y) * alpha;
+        return _y;
+    }
+
+    T    value() const { return _y; }
+    void reset(T value = 0)
+    {
+        _y     = value;
+        _first = true;
+    }
+
+private:
+    T    _tau;
+    T    _y     = 0;
+    bool _first = true;
+};
+
+enum class BiquadType
+{
+    LOW_PASS,
+    HIGH_PASS,
+    BAND_PASS // constant 0 dB peak gain
+};
+
+/**
+ * @brief Second order section (RBJ cookbook), transposed direct form II
+ *
+ * process(x) runs at the sample rate given to setup(), process(x, dt)
+ * re-derives the coefficients when the actual rate drifts by more than 1%.
+ * Coefficients are computed in float; with fixed-point T keep the cutoff
+ * well above sample_rate / 1000 or b0 rounds to zero.
+ */
+template <typename T = float>
+class Biquad
+{
+public:
+    Biquad() = default;
+    Biquad(BiquadType type, float cutoff_hz, float sample_rate_hz, float q = float(M_SQRT1_2))
+    {
+        setup(type, cutoff_hz, sample_rate_hz, q);
+    }
+
+    void setup(BiquadType type, float cutoff_hz, float sample_rate_hz, float q = float(M_SQRT1_2))
+    {
+        _type      = type;
+        _cutoff_hz = cutoff_hz;
+        _q         = q;
+        setSampleRate(sample_rate_hz);
+    }
+
+    void setSampleRate(float sample_rate_hz)
+    {
+        _sample_rate_hz = sample_rate_hz;
+
+        const float fc    = clipf(_cutoff_hz, 1e-3f, sample_rate_hz * 0.45f);
+        const float w0    = detail::TWO_PI_F * fc / sample_rate_hz;
+        const float cosw0 = cosf(w0);
+        const float alpha = sinf(w0) / (2.0f * _q);
+        const float a0    = 1.0f + alpha;
+
+        float b0, b1, b2;
+        switch (_type)
+        {
+            case BiquadType::HIGH_PASS:
+                b0 = (1.0f + cosw0) * 0.5f;
+                b1 = -(1.0f + cosw0);
+                b2 = b0;
+                break;
+            case BiquadType::BAND_PASS:
+                b0 = alpha;
+                b1 = 0;
+                b2 = -alpha;
+                break;
+            case BiquadType::LOW_PASS:
+            default:
+                b0 = (1.0f - cosw0) * 0.5f;
+                b1 = 1.0f - cosw0;
+                b2 = b0;
+                break;
+        }
+
+        _b0 = T(b0 / a0);
+        _b1 = T(b1 / a0);
+        _b2 = T(b2 / a0);
+        _a1 = T(-2.0f * cosw0 / a0);
+        _a2 = T((1.0f - alpha) / a0);
+    }
+
+    T process(T x)
+    {
+        const T y = _b0 * x + _z1;
+        _z1       = _b1 * x - _a1 * y + _z2;
+        _z2       = _b2 * x - _a2 * y;
+        _y        = y;
+        return y;
+    }
+
+    T process(T x, T dt_s)
+    {
+        const float rate = 1.0f / float(dt_s);
+        if (float(dt_s) > 0 && std::fabs(rate - _sample_rate_hz) > _sample_rate_hz * 0.01f)
+            setSampleRate(rate);
+        return process(x);
+    }
+
+    T    value() const { return _y; }
+    void reset(T value = 0)
+    {
+        _y = value;
+        // steady state for a constant input `value` (DC gain is 1 for low-pass, 0 otherwise)
+        const T dc = (_type == BiquadType::LOW_PASS) ? value : T(0);
+        _z1        = dc - _b0 * value;
+        _z2        = _b2 * value - _a2 * dc;
+    }
+
+    float cutoff() const { return _cutoff_hz; }
+    float sampleRate() const { return _sample_rate_hz; }
+
+private:
+    BiquadType _type           = BiquadType::LOW_PASS;
+    float      _cutoff_hz      = 10;
+    float      _q              = float(M_SQRT1_2);
+    float      _sample_rate_hz = 1000;
+
+    T _b0 = 1, _b1 = 0, _b2 = 0, _a1 = 0, _a2 = 0;
+    T _z1 = 0, _z2 = 0;
+    T _y  = 0;
+};
+
+/**
+ * @brief One-euro filter (Casiez et al. 2012) for noisy knobs/sensors
+ *
+ * Smooths strongly while the signal is still (min_cutoff) and follows fast
+ * when it moves (beta * speed raises the cutoff).
+ */
+template <typename T = float>
+class OneEuro
+{
+public:
+    explicit OneEuro(T min_cutoff_hz = T(1.0f), T beta = T(0.0f), T d_cutoff_hz = T(1.0f))
+        : _min_cutoff(min_cutoff_hz), _beta(beta), _d_cutoff(d_cutoff_hz)
+    {
+    }
+
+    void setParams(T min_cutoff_hz, T beta, T d_cutoff_hz = T(1.0f))
+    {
+        _min_cutoff = min_cutoff_hz;
+        _beta       = beta;
+        _d_cutoff   = d_cutoff_hz;
+    }
+
+    T process(T x, T dt_s)
+    {
+        if (_first || !(dt_s > T(0)))
+        {
+            _first = false;
+            _x     = x;
+            _dx    = 0;
+            return _x;
+        }
+
+        const T dx = (x - _x) / dt_s;
+        _dx += (dx - _dx) * alpha(_d_cutoff, dt_s);
+
+        const T cutoff = _min_cutoff + _beta * detail::absT(_dx);
+        _x += (x - _x) * alpha(cutoff, dt_s);
+        return _x;
+    }
+
+    T    value() const { return _x; }
+    void reset(T value = 0)
+    {
+        _x     = value;
+        _dx    = 0;
+        _first = true;
+    }
+
+private:
+    static T alpha(T cutoff_hz, T dt_s)
+    {
+        const T tau = T(1) / (T(detail::TWO_PI_F) * cutoff_hz);
+        return detail::smoothingFactor(dt_s, tau);
+    }
+
+    T    _min_cutoff, _beta, _d_cutoff;
+    T    _x     = 0;
+    T    _dx    = 0;
+    bool _first = true;
+};
+
+/**
+ * @brief Running median over the last N samples (N odd recommended)
+ *
+ * Ring buffer plus a sorted copy updated by one remove/insert, O(N) per
+ * sample with small N, no allocation.
+ */
+template <int N, typename T = float>
+class RunningMedian
+{
+    static_assert(N > 0, "RunningMedian needs N > 0");
+
+public:
+    T process(T x)
+    {
+        if (_count < N)
+        {
+            insertSorted(x, _count);
+            _ring[_count++] = x;
+        }
+        else
+        {
+            removeSorted(_ring[_pos]);
+            insertSorted(x, N - 1);
+            _ring[_pos] = x;
+            _pos        = (_pos + 1) % N;
+        }
+        _y = _sorted[_count / 2];
+        return _y;
+    }
+
+    T process(T x, T) { return process(x); }
+
+    T    value() const { return _y; }
+    void reset(T value = 0)
+    {
+        _count = 0;
+        _pos   = 0;
+        _y     = value;
+    }
+
+private:
+    void removeSorted(T x)
+    {
+        int i = 0;
+        while (i < N - 1 && !(_sorted[i] == x))
+            i++;
+        for (; i < N - 1; i++)
+            _sorted[i] = _sorted[i + 1];
+    }
+
+    void insertSorted(T x, int size)
+    {
+        int i = size;
+        while (i > 0 && _sorted[i - 1] > x)
+        {
+            _sorted[i] = _sorted[i - 1];
+            i--;
+        }
+        _sorted[i] = x;
+    }
+
+    T   _ring[N]   = {};
+    T   _sorted[N] = {};
+    int _count     = 0;
+    int _pos       = 0;
+    T   _y         = 0;
+};
+
+/**
+ * @brief Moving average over the last `window` (<= N) samples
+ *
+ * Keeps a running sum, O(1) per sample. With float the sum is rebuilt from
+ * the ring once per `window` samples so rounding cannot accumulate, that
+ * sample costs O(window) (amortized O(1)).
+ */
+template <int N, typename T = float>
+class MovingAverage
+{
+    static_assert(N > 0, "MovingAverage needs N > 0");
+
+public:
+    explicit MovingAverage(int window = N) { setWindow(window); }
+
+    void setWindow(int window)
+    {
+        _window = clip(window, 1, N);
+        reset(_y);
+    }
+
+    int window() const { return _window; }
+
+    T process(T x)
+    {
+        _sum += x - _ring[_pos];
+        _ring[_pos] = x;
+        if (++_pos >= _window)
+        {
+            _pos = 0;
+            if constexpr (std::is_floating_point<T>::value)
+            {
+                _sum = 0;
+                for (int i = 0; i < _window; i++)
+                    _sum += _ring[i];
+            }
+        }
+        _y = _sum / T(_window);
+        return _y;
+    }
+
+    T process(T x, T) { return process(x); }
+
+    T    value() const { return _y; }
+    void reset(T value = 0)
+    {
+        for (T& v : _ring)
+            v = value;
+        _sum = value * T(_window);
+        _pos = 0;
+        _y   = value;
+    }
+
+private:
+    T   _ring[N] = {};
+    T   _sum     = 0;
+    int _window  = N;
+    int _pos     = 0;
+    T   _y       = 0;
+};
+
+} // namespace filter
+} // namespace util
@@ -0,0 +1,252 @@
+#pragma once
+
+/**
+ * @file fixed_point.h
+ * @brief Saturating fixed-point numbers for targets without FPU (ESP8266, ESP32-C3/C6)
+ *
+ * util::fixed<FRAC_BITS, STORAGE> behaves like a number type (+ - * / and
+ * comparisons), every operation saturates at the storage limits instead of
+ * wrapping around. Conversions from float are constexpr, so constants cost
+ * nothing at runtime.
+ *
+ *  q15     = fixed<15, int16_t>  range [-1, 1)         resolution 3.1e-5
+ *  q16_16  = fixed<16, int32_t>  range [-32768, 32768) resolution 1.5e-5
+ *
+ * q15 is for normalised signals (filters, mapf/clipf), PID_T needs q16_16.
+ * util::bench::checkFixedPoint() (host/benchmark_suite.h) bounds the error
+ * of both against the float versions.
+ *
+ * Usage:
+ *
+ * util::q16_16 x = 0.25;
+ * x = util::mapConstrainf(x, 0, 1, 0, 255);
+ * PID_T<util::q16_16> pid;
+ *
+ * util::real_t is float by default and q16_16 when UTIL_FIXED_POINT is set
+ * (add -D UTIL_FIXED_POINT=1 to build_flags).
+ */
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+#include "basics.h"
+
+#ifndef UTIL_FIXED_POINT
+#define UTIL_FIXED_POINT 0
+#endif
+
+namespace util {
+
+template <int FRAC_BITS, typename STORAGE = int32_t>
+class fixed
+{
+    static_assert(std::is_signed<STORAGE>::value, "fixed needs a signed storage type");
+    static_assert(FRAC_BITS > 0 && FRAC_BITS < int(sizeof(STORAGE) * 8), "invalid FRAC_BITS");
+
+public:
+    using storage_t = STORAGE;
+    using wide_t    = typename std::conditional<(sizeof(STORAGE) < 4), int32_t, int64_t>::type;
+
+    static constexpr int       frac_bits = FRAC_BITS;
+    static constexpr storage_t raw_max   = std::numeric_limits<storage_t>::max();
+    static constexpr storage_t raw_min   = std::numeric_limits<storage_t>::min();
+    static constexpr wide_t    raw_one   = wide_t(1) << FRAC_BITS;
+
+    constexpr fixed() = default;
+    constexpr fixed(int value) : _raw(saturate(wide_t(value) * raw_one)) {}
+    constexpr fixed(float value) : fixed(double(value)) {}
+    constexpr fixed(double value) : _raw(fromDouble(value)) {}
+
+    static constexpr fixed fromRaw(storage_t raw)
+    {
+        fixed f;
+        f._raw = raw;
+        return f;
+    }
+
+    static constexpr fixed max() { return fromRaw(raw_max); }
+    static constexpr fixed min() { return fromRaw(raw_min); }
+    static constexpr fixed epsilon() { return fromRaw(1); }
+
+    constexpr storage_t raw() const { return _raw; }
+    constexpr float     toFloat() const { return float(_raw) / float(raw_one); }
+    constexpr int       toInt() const { return int(_raw >> FRAC_BITS); } // floor
+
+    explicit constexpr operator float() const { return toFloat(); }
+    explicit constexpr operator int() const { return toInt(); }
+
+    // saturating arithmetic
+    constexpr fixed operator-() const { return fromRaw(saturate(-wide_t(_raw))); }
+    constexpr fixed operator+(fixed rhs) const { return fromRaw(saturate(wide_t(_raw) + rhs._raw)); }
+    constexpr fixed operator-(fixed rhs) const { return fromRaw(saturate(wide_t(_raw) - rhs._raw)); }
+    constexpr fixed operator*(fixed rhs) const
+    {
+        const wide_t product = wide_t(_raw) * rhs._raw;
+        return fromRaw(saturate((product + (wide_t(1) << (FRAC_BITS - 1))) >> FRAC_BITS)); // rounded
+    }
+    constexpr fixed operator/(fixed rhs) const
+    {
+        if (rhs._raw == 0)
+            return _raw >= 0 ? max() : min();
+        const wide_t num  = wide_t(_raw) * raw_one;
+        const wide_t half = (rhs._raw < 0 ? -wide_t(rhs._raw) : wide_t(rhs._raw)) / 2;
+        return fromRaw(saturate(((num < 0) != (rhs._raw < 0) ? num - half : num + half) / rhs._raw)); // rounded
+    }
+
+    fixed& operator+=(fixed rhs) { return *this = *this + rhs; }
+    fixed& operator-=(fixed rhs) { return *this = *this - rhs; }
+    fixed& operator*=(fixed rhs) { return *this = *this * rhs; }
+    fixed& operator/=(fixed rhs) { return *this = *this / rhs; }
+
+    friend constexpr bool operator==(fixed a, fixed b) { return a._raw == b._raw; }
+    friend constexpr bool operator!=(fixed a, fixed b) { return a._raw != b._raw; }
+    friend constexpr bool operator<(fixed a, fixed b) { return a._raw < b._raw; }
+    friend constexpr bool operator>(fixed a, fixed b) { return a._raw > b._raw; }
+    friend constexpr bool operator<=(fixed a, fixed b) { return a._raw <= b._raw; }
+    friend constexpr bool operator>=(fixed a, fixed b) { return a._raw >= b._raw; }
+
+private:
+    storage_t _raw = 0;
+
+    static constexpr storage_t saturate(wide_t value)
+    {
+        return value > raw_max ? raw_max : (value < raw_min ? raw_min : storage_t(value));
+    }
+
+    static constexpr storage_t fromDouble(double value)
+    {
+        const double scaled = value * double(raw_one);
+        if (scaled >= double(raw_max))
+            return raw_max;
+        if (scaled <= double(raw_min))
+            return raw_min;
+        return storage_t(scaled >= 0 ? scaled + 0.5 : scaled - 0.5);
+    }
+};
+
+using q15    = fixed<15, int16_t>;
+using q16_16 = fixed<16, int32_t>;
+
+#if UTIL_FIXED_POINT
+using real_t = q16_16;
+#else
+using real_t = float;
+#endif
+
+template <typename T>
+struct is_fixed : std::false_type
+{
+};
+
+template <int F, typename S>
+struct is_fixed<fixed<F, S>> : std::true_type
+{
+};
+
+template <int F, typename S>
+constexpr fixed<F, S> fabs(fixed<F, S> value)
+{
+    return value < fixed<F, S>(0) ? -value : value;
+}
+
+template <int F, typename S>
+constexpr fixed<F, S> abs(fixed<F, S> value)
+{
+    return fabs(value);
+}
+
+// --------------------------------------------------------------------------
+// basics.h overloads: the range arguments are non-deduced, so plain literals
+// work: util::mapf(x, 0, 1, 0, 255)
+
+template <typename T>
+struct same_type
+{
+    using type = T;
+};
+template <typename T>
+using same_t = typename same_type<T>::type;
+
+template <int F, typename S>
+constexpr fixed<F, S> clipf(fixed<F, S> value, same_t<fixed<F, S>> low, same_t<fixed<F, S>> high)
+{
+    return value < low ? low : (value > high ? high : value);
+}
+
+template <int F, typename S>
+constexpr fixed<F, S> mapf(fixed<F, S>         value,
+                           same_t<fixed<F, S>> fromLow,
+                           same_t<fixed<F, S>> fromHigh,
+                           same_t<fixed<F, S>> toLow,
+                           same_t<fixed<F, S>> toHigh)
+{
+    return (value - fromLow) * (toHigh - toLow) / (fromHigh - fromLow) + toLow;
+}
+
+template <int F, typename S>
+constexpr fixed<F, S> mapConstrainf(fixed<F, S>         value,
+                                    same_t<fixed<F, S>> fromLow,
+                                    same_t<fixed<F, S>> fromHigh,
+                                    same_t<fixed<F, S>> toLow,
+                                    same_t<fixed<F, S>> toHigh)
+{
+    return clipf(mapf(value, fromLow, fromHigh, toLow, toHigh), toLow, toHigh);
+}
+
+// constant time wrap into [low, high) on the raw integer representation
+template <int F, typename S>
+constexpr fixed<F, S> wrap(fixed<F, S> value, fixed<F, S> low, fixed<F, S> high)
+{
+    if (value >= low && value < high)
+        return value;
+
+    using wide_t       = typename fixed<F, S>::wide_t;
+    const wide_t range = wide_t(high.raw()) - low.raw();
+    wide_t       r     = (wide_t(value.raw()) - low.raw()) % range;
+    if (r < 0)
+        r += range;
+    return fixed<F, S>::fromRaw(S(r + low.raw()));
+}
+
+} // namespace util
+
+// --------------------------------------------------------------------------
+// filter.h overloads
+
+template <int F, typename S>
+void simpleFilterf(util::fixed<F, S>&               value,
+                   util::same_t<util::fixed<F, S>> target,
+                   util::same_t<util::fixed<F, S>> filterFactor = 0.2,
+                   util::same_t<util::fixed<F, S>> lastStep     = 0.01)
+{
+    using T = util::fixed<F, S>;
+    if (value == target)
+        return;
+    else if (util::fabs(value - target) <= lastStep)
+        value = target;
+    else
+        value = value * (T(1) - filterFactor) + target * filterFactor;
+}
+
+template <int F, typename S>
+void simpleFilterWrapf(util::fixed<F, S>&               value,
+                       util::same_t<util::fixed<F, S>> target,
+                       util::same_t<util::fixed<F, S>> filterFactor = 0.2,
+                       util::same_t<util::fixed<F, S>> lastStep     = 0.01)
+{
+    using T = util::fixed<F, S>;
+    if (value == target)
+        return;
+    else if (util::fabs(value - target) <= lastStep)
+        value = target;
+    else
+    {
+        T diff = target - value;
+        if (diff > T(0.5))
+            diff -= T(1);
+        else if (diff < T(-0.5))
+            diff += T(1);
+        value += diff * filterFactor;
+    }
+}
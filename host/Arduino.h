@@ -0,0 +1,434 @@
+#pragma once
+
+/**
+ * @file Arduino.h
+ * @brief Host-side (native/Linux) stand-in for the Arduino core.
+ *
+ * Only the subset of the core that this library touches is provided:
+ * - a deterministic virtual clock behind millis()/micros()/delay()
+ * - a recording backend for pinMode/analogWrite/ledcWrite
+ * - a small String, Print/Stream and Serial (writes to stdout)
+ * - seeded random()
+ *
+ * Usage (platformio native env):
+ *
+ * [env:native]
+ * platform = native
+ * build_flags = -std=gnu++17 -I lib/util/host
+ *
+ * host::clock::advance_ms(2); // time only moves when you move it
+ */
+
+#ifndef ARDUINO_HOST
+#define ARDUINO_HOST 1
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+
+using std::abs;
+
+typedef uint8_t byte;
+
+#define PI 3.1415926535897932384626433832795
+#define HALF_PI 1.5707963267948966192313216916398
+#define TWO_PI 6.283185307179586476925286766559
+
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+#define DEC 10
+#define HEX 16
+
+#define F(string_literal) (string_literal)
+
+template <typename T, typename L, typename H>
+auto constrain(T amt, L low, H high) -> decltype(amt + low + high)
+{
+    return amt < low ? low : (amt > high ? high : amt);
+}
+
+// ==============================
+// virtual clock
+// ==============================
+namespace host {
+
+struct clock
+{
+    static inline std::atomic<uint64_t> now_us{0}; // read from task threads (dual_core.h)
+
+    static void     set_us(uint64_t us) { now_us = us; }
+    static void     advance_us(uint64_t us) { now_us += us; }
+    static void     advance_ms(uint32_t ms) { now_us += uint64_t(ms) * 1000; }
+    static uint64_t us() { return now_us; }
+    static void     reset() { now_us = 0; }
+};
+
+} // namespace host
+
+// 32 bit like on target: micros() wraps after 71 min, millis() after 49 days
+inline unsigned long millis() { return static_cast<uint32_t>(host::clock::now_us / 1000); }
+inline unsigned long micros() { return static_cast<uint32_t>(host::clock::now_us); }
+inline void          delay(unsigned long ms) { host::clock::advance_ms(ms); }
+inline void          delayMicroseconds(unsigned int us) { host::clock::advance_us(us); }
+inline void          yield() {}
+
+// ==============================
+// random (deterministic, seedable)
+// ==============================
+namespace host {
+
+struct rng
+{
+    static inline uint32_t state = 0x12345678u;
+
+    static uint32_t next()
+    {
+        // xorshift32
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+};
+
+} // namespace host
+
+inline void randomSeed(unsigned long seed) { host::rng::state = seed ? uint32_t(seed) : 0x12345678u; }
+
+inline long random(long howbig)
+{
+    if (howbig <= 0)
+        return 0;
+    return long(host::rng::next() % uint32_t(howbig));
+}
+
+inline long random(long howsmall, long howbig)
+{
+    if (howsmall >= howbig)
+        return howsmall;
+    return random(howbig - howsmall) + howsmall;
+}
+
+// ==============================
+// pins / PWM recording backend
+// ==============================
+namespace host {
+
+struct pin_state
+{
+    int      mode        = -1;
+    int      digital     = 0;
+    uint32_t duty        = 0; // last analogWrite/ledcWrite value
+    uint32_t frequency   = 0;
+    uint8_t  resolution  = 8;
+    uint32_t write_count = 0;
+    bool     attached    = false;
+};
+
+struct pins
+{
+    static inline std::map<uint8_t, pin_state> state;
+    static inline uint32_t                     analog_frequency  = 1000;
+    static inline uint8_t                      analog_resolution = 8;
+
+    static pin_state& get(uint8_t pin) { return state[pin]; }
+    static void       reset() { state.clear(); }
+
+    static void record(uint8_t pin, uint32_t duty)
+    {
+        pin_state& s = state[pin];
+        s.duty = duty;
+        s.write_count++;
+    }
+};
+
+} // namespace host
+
+inline void pinMode(uint8_t pin, uint8_t mode) { host::pins::get(pin).mode = mode; }
+inline void digitalWrite(uint8_t pin, uint8_t val) { host::pins::get(pin).digital = val; }
+inline int  digitalRead(uint8_t pin) { return host::pins::get(pin).digital; }
+
+inline void analogWriteFreq(uint32_t freq) { host::pins::analog_frequency = freq; }
+inline void analogWriteResolution(uint8_t bits) { host::pins::analog_resolution = bits; }
+inline void analogWrite(uint8_t pin, int value) { host::pins::record(pin, uint32_t(value)); }
+
+// arduino-esp32 v3 (pin based) ledc API
+inline bool ledcAttach(uint8_t pin, uint32_t freq, uint8_t resolution)
+{
+    host::pin_state& s = host::pins::get(pin);
+    s.frequency  = freq;
+    s.resolution = resolution;
+    s.attached   = true;
+    return true;
+}
+inline bool ledcDetach(uint8_t pin)
+{
+    host::pins::get(pin).attached = false;
+    return true;
+}
+inline bool ledcWrite(uint8_t pin, uint32_t duty)
+{
+    host::pins::record(pin, duty);
+    return true;
+}
+
+// arduino-esp32 v2 (channel based) ledc API, channels are recorded as pins
+inline uint32_t ledcSetup(uint8_t channel, uint32_t freq, uint8_t resolution)
+{
+    ledcAttach(channel, freq, resolution);
+    return freq;
+}
+inline void ledcAttachPin(uint8_t pin, uint8_t channel) {}
+
+// ==============================
+// String
+// ==============================
+class String
+{
+public:
+    String() = default;
+    String(const char* s) : _s(s ? s : "") {}
+    String(const std::string& s) : _s(s) {}
+    String(char c) : _s(1, c) {}
+    String(int value, unsigned char base = DEC) : _s(format_integer(long(value), base)) {}
+    String(unsigned int value, unsigned char base = DEC) : _s(format_integer(long(value), base)) {}
+    String(long value, unsigned char base = DEC) : _s(format_integer(value, base)) {}
+    String(unsigned long value, unsigned char base = DEC) : _s(format_integer(long(value), base)) {}
+    String(float value, unsigned int decimals = 2) : _s(format_float(value, decimals)) {}
+    String(double value, unsigned int decimals = 2) : _s(format_float(value, decimals)) {}
+
+    const char*        c_str() const { return _s.c_str(); }
+    unsigned int       length() const { return unsigned(_s.size()); }
+    bool               isEmpty() const { return _s.empty(); }
+    const std::string& str() const { return _s; }
+
+    char  charAt(unsigned int index) const { return index < _s.size() ? _s[index] : 0; }
+    char  operator[](unsigned int index) const { return charAt(index); }
+    char& operator[](unsigned int index) { return _s[index]; }
+
+    int indexOf(char c, unsigned int from = 0) const { return to_index(_s.find(c, from)); }
+    int indexOf(const String& s, unsigned int from = 0) const { return to_index(_s.find(s._s, from)); }
+    int lastIndexOf(char c) const { return to_index(_s.rfind(c)); }
+    int lastIndexOf(const String& s) const { return to_index(_s.rfind(s._s)); }
+
+    String substring(unsigned int begin) const { return begin < _s.size() ? String(_s.substr(begin)) : String(); }
+    String substring(unsigned int begin, unsigned int end) const
+    {
+        if (begin > end)
+            std::swap(begin, end);
+        if (begin >= _s.size())
+            return String();
+        return String(_s.substr(begin, end - begin));
+    }
+
+    void replace(const String& find, const String& replacement)
+    {
+        if (find._s.empty())
+            return;
+        size_t pos = 0;
+        while ((pos = _s.find(find._s, pos)) != std::string::npos)
+        {
+            _s.replace(pos, find._s.size(), replacement._s);
+            pos += replacement._s.size();
+        }
+    }
+
+    void trim()
+    {
+        const char* ws = " \t\r\n";
+        _s.erase(0, _s.find_first_not_of(ws));
+        _s.erase(_s.find_last_not_of(ws) + 1);
+    }
+
+    bool startsWith(const String& prefix) const { return _s.compare(0, prefix._s.size(), prefix._s) == 0; }
+    bool endsWith(const String& suffix) const
+    {
+        return _s.size() >= suffix._s.size() &&
+               _s.compare(_s.size() - suffix._s.size(), suffix._s.size(), suffix._s) == 0;
+    }
+
+    long  toInt() const { return std::strtol(_s.c_str(), nullptr, 10); }
+    float toFloat() const { return std::strtof(_s.c_str(), nullptr); }
+
+    bool reserve(unsigned int size)
+    {
+        _s.reserve(size);
+        return true;
+    }
+
+    // ArduinoJson writer interface
+    size_t write(uint8_t c)
+    {
+        _s.push_back(char(c));
+        return 1;
+    }
+    size_t write(const uint8_t* buffer, size_t size)
+    {
+        _s.append(reinterpret_cast<const char*>(buffer), size);
+        return size;
+    }
+
+    String& operator+=(const String& rhs)
+    {
+        _s += rhs._s;
+        return *this;
+    }
+    String& operator+=(const char* rhs)
+    {
+        _s += rhs;
+        return *this;
+    }
+    String& operator+=(char rhs)
+    {
+        _s += rhs;
+        return *this;
+    }
+
+    friend String operator+(String lhs, const String& rhs) { return lhs += rhs; }
+    friend String operator+(String lhs, const char* rhs) { return lhs += rhs; }
+    friend String operator+(const char* lhs, const String& rhs) { return String(lhs) += rhs; }
+
+    friend bool operator==(const String& a, const String& b) { return a._s == b._s; }
+    friend bool operator==(const String& a, const char* b) { return a._s == b; }
+    friend bool operator!=(const String& a, const String& b) { return a._s != b._s; }
+    friend bool operator!=(const String& a, const char* b) { return a._s != b; }
+    friend bool operator<(const String& a, const String& b) { return a._s < b._s; }
+
+private:
+    std::string _s;
+
+    static int to_index(size_t pos) { return pos == std::string::npos ? -1 : int(pos); }
+
+    static std::string format_integer(long value, unsigned char base)
+    {
+        char buffer[40];
+        if (base == HEX)
+            std::snprintf(buffer, sizeof(buffer), "%lx", value);
+        else
+            std::snprintf(buffer, sizeof(buffer), "%ld", value);
+        return buffer;
+    }
+
+    static std::string format_float(double value, unsigned int decimals)
+    {
+        char buffer[48];
+        std::snprintf(buffer, sizeof(buffer), "%.*f", int(decimals), value);
+        return buffer;
+    }
+};
+
+// ==============================
+// Print / Stream / Serial
+// ==============================
+class Print
+{
+public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size)
+    {
+        size_t n = 0;
+        while (size--)
+            n += write(*buffer++);
+        return n;
+    }
+    size_t write(const char* str) { return write(reinterpret_cast<const uint8_t*>(str), std::strlen(str)); }
+    virtual void flush() {}
+
+    size_t print(const char* s) { return write(s); }
+    size_t print(const String& s) { return write(s.c_str()); }
+    size_t print(char c) { return write(uint8_t(c)); }
+    size_t print(int v) { return print(String(v)); }
+    size_t print(unsigned int v) { return print(String(v)); }
+    size_t print(long v) { return print(String(v)); }
+    size_t print(unsigned long v) { return print(String(v)); }
+    size_t print(double v, int decimals = 2) { return print(String(v, unsigned(decimals))); }
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(const T& v)
+    {
+        size_t n = print(v);
+        return n + println();
+    }
+
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)))
+    {
+        char    buffer[256];
+        va_list args;
+        va_start(args, format);
+        int len = std::vsnprintf(buffer, sizeof(buffer), format, args);
+        va_end(args);
+        if (len < 0)
+            return 0;
+        return write(reinterpret_cast<const uint8_t*>(buffer),
+                     std::min(size_t(len), sizeof(buffer) - 1));
+    }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read()      = 0;
+    virtual int peek()      = 0;
+
+    size_t readBytes(char* buffer, size_t length)
+    {
+        size_t count = 0;
+        while (count < length)
+        {
+            int c = read();
+            if (c < 0)
+                break;
+            *buffer++ = char(c);
+            count++;
+        }
+        return count;
+    }
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes(reinterpret_cast<char*>(buffer), length); }
+
+    String readStringUntil(char terminator)
+    {
+        std::string s;
+        int         c;
+        while ((c = read()) >= 0 && c != terminator)
+            s.push_back(char(c));
+        return String(s);
+    }
+
+    String readString() { return readStringUntil('\0'); }
+};
+
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long baud) {}
+    void end() {}
+
+    size_t write(uint8_t c) override { return std::fputc(c, stdout) == EOF ? 0 : 1; }
+    size_t write(const uint8_t* buffer, size_t size) override { return std::fwrite(buffer, 1, size, stdout); }
+    using Print::write;
+
+    int  available() override { return 0; }
+    int  read() override { return -1; }
+    int  peek() override { return -1; }
+    void flush() override { std::fflush(stdout); }
+
+    explicit operator bool() const { return true; }
+};
+
+inline HardwareSerial Serial;
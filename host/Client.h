@@ -0,0 +1,104 @@
+#pragma once
+
+// Host-side Arduino Client interface plus a loopback implementation.
+//
+// LoopbackClient keeps two byte queues: everything the code under test write()s
+// lands in `tx` (inspect it from the test), everything pushed into `rx` via
+// inject() is returned by read(). With `echo = true` written bytes are fed
+// straight back to the reader.
+
+#include "Arduino.h"
+#include "IPAddress.h"
+#include <deque>
+#include <string>
+
+class Client : public Stream
+{
+public:
+    virtual int     connect(IPAddress ip, uint16_t port)      = 0;
+    virtual int     connect(const char* host, uint16_t port)  = 0;
+    virtual size_t  write(uint8_t)                            = 0;
+    virtual size_t  write(const uint8_t* buf, size_t size)    = 0;
+    virtual int     available()                               = 0;
+    virtual int     read()                                    = 0;
+    virtual int     read(uint8_t* buf, size_t size)           = 0;
+    virtual int     peek()                                    = 0;
+    virtual void    flush()                                   = 0;
+    virtual void    stop()                                    = 0;
+    virtual uint8_t connected()                               = 0;
+    virtual operator bool()                                   = 0;
+    using Print::write;
+};
+
+namespace host {
+
+class LoopbackClient : public Client
+{
+public:
+    std::string       tx;
+    std::deque<uint8_t> rx;
+
+    bool reachable = true; // connect() result
+    bool echo      = false;
+
+    uint32_t connect_count = 0;
+
+    void inject(const uint8_t* data, size_t size) { rx.insert(rx.end(), data, data + size); }
+    void inject(const std::string& data)
+    {
+        inject(reinterpret_cast<const uint8_t*>(data.data()), data.size());
+    }
+
+    int connect(IPAddress ip, uint16_t port) override { return open(); }
+    int connect(const char* host, uint16_t port) override { return open(); }
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buf, size_t size) override
+    {
+        if (!_connected)
+            return 0;
+        tx.append(reinterpret_cast<const char*>(buf), size);
+        if (echo)
+            inject(buf, size);
+        return size;
+    }
+    using Client::write;
+
+    int available() override { return int(rx.size()); }
+    int read() override
+    {
+        if (rx.empty())
+            return -1;
+        uint8_t c = rx.front();
+        rx.pop_front();
+        return c;
+    }
+    int read(uint8_t* buf, size_t size) override
+    {
+        size_t n = 0;
+        while (n < size && !rx.empty())
+        {
+            buf[n++] = rx.front();
+            rx.pop_front();
+        }
+        return int(n);
+    }
+    int peek() override { return rx.empty() ? -1 : rx.front(); }
+
+    void    flush() override {}
+    void    stop() override { _connected = false; }
+    uint8_t connected() override { return _connected; }
+    operator bool() override { return _connected; }
+
+private:
+    bool _connected = false;
+
+    int open()
+    {
+        connect_count++;
+        _connected = reachable;
+        return _connected ? 1 : 0;
+    }
+};
+
+} // namespace host
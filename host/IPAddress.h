@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Arduino.h"
+
+class IPAddress
+{
+public:
+    IPAddress() = default;
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : _bytes{a, b, c, d} {}
+
+    bool fromString(const char* address)
+    {
+        unsigned int a, b, c, d;
+        if (std::sscanf(address, "%u.%u.%u.%u", &a, &b, &c, &d) != 4)
+            return false;
+        *this = IPAddress(uint8_t(a), uint8_t(b), uint8_t(c), uint8_t(d));
+        return true;
+    }
+
+    String toString() const
+    {
+        char buffer[16];
+        std::snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", _bytes[0], _bytes[1], _bytes[2], _bytes[3]);
+        return String(buffer);
+    }
+
+    uint8_t operator[](int index) const { return _bytes[index]; }
+
+    friend bool operator==(const IPAddress& a, const IPAddress& b)
+    {
+        return std::memcmp(a._bytes, b._bytes, 4) == 0;
+    }
+
+private:
+    uint8_t _bytes[4] = {0, 0, 0, 0};
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+// Host-side in-memory SPIFFS. Files live in a std::map for the lifetime of the
+// process, so spiffs_helper.h / parameter_data.h can be exercised natively.
+//
+// host::fs::files()["/ssid.txt"] = "my_wifi"; // preload before initFS()
+
+#include "Arduino.h"
+#include <map>
+#include <memory>
+#include <string>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace host {
+
+struct fs
+{
+    static std::map<std::string, std::string>& files()
+    {
+        static std::map<std::string, std::string> f;
+        return f;
+    }
+};
+
+} // namespace host
+
+class File : public Stream
+{
+public:
+    File() = default;
+    File(const std::string& path, const char* mode) : _path(path), _valid(true)
+    {
+        _writable = mode[0] == 'w' || mode[0] == 'a';
+        if (mode[0] == 'w')
+            host::fs::files()[_path].clear();
+        else
+            host::fs::files()[_path]; // create on append, no-op on read
+    }
+
+    explicit operator bool() const { return _valid; }
+    bool isDirectory() const { return false; }
+    const char* path() const { return _path.c_str(); }
+    const char* name() const { return _path.c_str(); }
+
+    size_t size() const { return _valid ? content().size() : 0; }
+
+    size_t write(uint8_t c) override
+    {
+        if (!_valid || !_writable)
+            return 0;
+        host::fs::files()[_path].push_back(char(c));
+        return 1;
+    }
+    size_t write(const uint8_t* buffer, size_t size) override
+    {
+        if (!_valid || !_writable)
+            return 0;
+        host::fs::files()[_path].append(reinterpret_cast<const char*>(buffer), size);
+        return size;
+    }
+    using Print::write;
+
+    int available() override { return _valid ? int(content().size() - _pos) : 0; }
+    int read() override { return available() > 0 ? uint8_t(content()[_pos++]) : -1; }
+    int peek() override { return available() > 0 ? uint8_t(content()[_pos]) : -1; }
+
+    void close() { _valid = false; }
+
+private:
+    const std::string& content() const { return host::fs::files()[_path]; }
+
+    std::string _path;
+    size_t      _pos      = 0;
+    bool        _valid    = false;
+    bool        _writable = false;
+};
+
+class SPIFFSFS
+{
+public:
+    bool begin(bool formatOnFail = false) { return true; }
+    void end() {}
+    bool format()
+    {
+        host::fs::files().clear();
+        return true;
+    }
+
+    File open(const char* path, const char* mode = FILE_READ)
+    {
+        if (mode[0] == 'r' && !exists(path))
+            return File();
+        return File(path, mode);
+    }
+    File open(const String& path, const char* mode = FILE_READ) { return open(path.c_str(), mode); }
+
+    bool exists(const char* path) const { return host::fs::files().count(path) > 0; }
+    bool exists(const String& path) const { return exists(path.c_str()); }
+    bool remove(const char* path) { return host::fs::files().erase(path) > 0; }
+    bool remove(const String& path) { return remove(path.c_str()); }
+};
+
+inline SPIFFSFS SPIFFS;
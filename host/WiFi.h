@@ -0,0 +1,32 @@
+#pragma once
+
+// Host-side WiFi stand-in: WiFiClient is the loopback client, the station is
+// always "connected" with a fixed MAC/IP.
+
+#include "Arduino.h"
+#include "Client.h"
+#include "IPAddress.h"
+
+#define WL_CONNECTED 3
+#define WL_DISCONNECTED 6
+#define WIFI_STA 1
+#define WIFI_AP 2
+
+using WiFiClient = host::LoopbackClient;
+
+class WiFiClass
+{
+public:
+    int status() { return _status; }
+    void mode(int m) {}
+    void begin(const char* ssid, const char* pass) { _status = WL_CONNECTED; }
+    bool softAP(const String& ssid) { return true; }
+
+    String    macAddress() { return "AA:BB:CC:DD:EE:FF"; }
+    IPAddress localIP() { return IPAddress(127, 0, 0, 1); }
+    IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+
+    int _status = WL_CONNECTED;
+};
+
+inline WiFiClass WiFi;
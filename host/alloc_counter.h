@@ -0,0 +1,102 @@
+#pragma once
+
+/**
+ * @file alloc_counter.h
+ * @brief Counts heap allocations on the host build
+ *
+ * The counters live here, the hooks that increment them only in the one
+ * translation unit that defines HOST_COUNT_ALLOCATIONS before the include
+ * (main.cpp). With glibc malloc() itself is interposed, so operator new,
+ * String and ArduinoJson's DynamicJsonDocument (malloc) are all counted,
+ * elsewhere only operator new is replaced.
+ *
+ * Usage:
+ *
+ * #define HOST_COUNT_ALLOCATIONS
+ * #include <alloc_counter.h>
+ *
+ * host::alloc::Scope scope;
+ * mqtt.publishLight("lamp", 0.5f);
+ * printf("%u allocations\n", unsigned(scope.allocations()));
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+namespace host {
+namespace alloc {
+
+inline std::atomic<uint64_t> allocations{0};
+inline std::atomic<uint64_t> bytes{0};
+inline std::atomic<bool>     hooked{false}; // true if some TU defined HOST_COUNT_ALLOCATIONS
+
+inline void count(size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+// allocations since construction
+class Scope
+{
+public:
+    Scope() : _allocations(alloc::allocations), _bytes(alloc::bytes) {}
+
+    uint64_t allocations() const { return alloc::allocations - _allocations; }
+    uint64_t bytes() const { return alloc::bytes - _bytes; }
+
+private:
+    uint64_t _allocations;
+    uint64_t _bytes;
+};
+
+} // namespace alloc
+} // namespace host
+
+#if defined(HOST_COUNT_ALLOCATIONS)
+
+static const bool host_alloc_hooked = (host::alloc::hooked = true);
+
+#if defined(__GLIBC__)
+
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+
+void* malloc(size_t size) noexcept
+{
+    host::alloc::count(size);
+    return __libc_malloc(size);
+}
+void* calloc(size_t count, size_t size) noexcept
+{
+    host::alloc::count(count * size);
+    return __libc_calloc(count, size);
+}
+void* realloc(void* ptr, size_t size) noexcept
+{
+    host::alloc::count(size);
+    return __libc_realloc(ptr, size);
+}
+}
+
+#else
+
+void* operator new(size_t size)
+{
+    host::alloc::count(size);
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void  operator delete(void* ptr) noexcept { std::free(ptr); }
+void  operator delete[](void* ptr) noexcept { std::free(ptr); }
+void  operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void  operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+
+#endif
+#endif
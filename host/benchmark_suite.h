@@ -0,0 +1,700 @@
+#pragma once
+
+/**
+ * @file benchmark_suite.h
+ * @brief Control-loop hot path benchmarks for the native build.
+ *
+ * Usage (native env main.cpp, checkLedAllocations() needs the allocation
+ * counter, see alloc_counter.h):
+ *
+ * #define HOST_COUNT_ALLOCATIONS
+ * #include "benchmark_suite.h"
+ *
+ * int main(int argc, char** argv)
+ * {
+ *     if (!util::bench::checkPidBank() || !util::bench::checkFixedPoint() || !util::bench::checkBatchHelpers())
+ *         return 1;
+ *     if (!util::bench::checkLedAllocations() || !util::bench::checkLedDithering() || !util::bench::checkLedGroup())
+ *         return 1;
+ *     if (!util::bench::checkScheduler() || !util::bench::checkTimerWheel())
+ *         return 1;
+ *     util::bench::Runner bench;
+ *     util::bench::runControlLoopSuite(bench);
+ *     bench.print();
+ *     if (argc > 2 && strcmp(argv[1], "--save") == 0)
+ *         return bench.saveBaseline(argv[2]) ? 0 : 1;
+ *     if (argc > 2 && strcmp(argv[1], "--check") == 0)
+ *         return bench.checkBaseline(argv[2]) ? 0 : 1;
+ *     return 0;
+ * }
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "../benchmark.h"
+#include "../fixed_point.h"
+#include "../led.h"
+#include "../led_group.h"
+#include "../pid.h"
+#include "../pid_bank.h"
+#include "../timer_wheel.h"
+#include "../util.h"
+#include "alloc_counter.h"
+
+namespace util {
+namespace bench {
+
+// fixed pseudo random inputs, filled once so the generator is not measured
+struct Inputs
+{
+    static constexpr int N = 1024;
+    float                values[N];
+
+    explicit Inputs(uint32_t seed = 1234)
+    {
+        randomSeed(seed);
+        for (int i = 0; i < N; i++)
+            values[i] = float(random(-10000, 10000)) / 10000.0f;
+    }
+
+    float operator[](uint32_t i) const { return values[i & (N - 1)]; }
+};
+
+inline void runControlLoopSuite(Runner& bench)
+{
+    static const Inputs in;
+    uint32_t            i = 0;
+
+    // -- PID --------------------------------------------------------------
+    PID pid;
+    pid.setParams(1.2f, 0.5f, 0.05f);
+    pid.setTarget(0.25f);
+    bench.run("pid.process", [&] { doNotOptimize(pid.process(in[i++])); });
+    bench.run("pid.process_unwrap", [&] { doNotOptimize(pid.process_unwrap(in[i++])); });
+
+    // 16 axes: scalar objects vs. one bank step
+    PID         pids[16];
+    PIDBank<16> bank;
+    float       bank_out[16];
+    for (int n = 0; n < 16; n++)
+    {
+        pids[n].setParams(1.2f, 0.5f, 0.05f);
+        pids[n].setTarget(0.25f);
+    }
+    bank.setParams(1.2f, 0.5f, 0.05f);
+    for (int n = 0; n < 16; n++)
+        bank.setTarget(n, 0.25f);
+
+    bench.run("pid.process.x16", [&] {
+        for (int n = 0; n < 16; n++)
+            doNotOptimize(pids[n].process(in[i + n]));
+        i += 16;
+    });
+    bench.run("pid_bank.process.x16", [&] {
+        bank.process(&in.values[i & (Inputs::N - 16)], bank_out);
+        doNotOptimize(bank_out[0]);
+        i += 16;
+    });
+
+    // -- filters ----------------------------------------------------------
+    float value = 0;
+    bench.run("filter.simpleFilterf", [&] {
+        simpleFilterf(value, in[i++]);
+        doNotOptimize(value);
+    });
+    bench.run("filter.simpleFilterWrapf", [&] {
+        simpleFilterWrapf(value, in[i++]);
+        doNotOptimize(value);
+    });
+
+    // -- map helpers ------------------------------------------------------
+    bench.run("util.mapf", [&] { doNotOptimize(mapf(in[i++], -1, 1, 0, 255)); });
+    bench.run("util.mapConstrainf", [&] { doNotOptimize(mapConstrainf(in[i++], -0.5f, 0.5f, 0, 1)); });
+    bench.run("util.mapLogf", [&] { doNotOptimize(mapLogf(in[i++] + 1.0f, 0, 2, 0, 1)); });
+    bench.run("util.mapExpf", [&] { doNotOptimize(mapExpf(in[i++], 0, 1, 0, 1, 2.2f)); });
+    bench.run("std.powf", [&] { doNotOptimize(::powf(in[i++] * 0.5f + 0.5f, 2.2f)); });
+    bench.run("util.lut.powf", [&] { doNotOptimize(lut::powf(in[i++] * 0.5f + 0.5f, 2.2f)); });
+    // wrap cost must not depend on how far the input is out of range
+    bench.run("util.wrapf", [&] { doNotOptimize(wrapf(in[i++] * 8.0f, -0.5f, 0.5f)); });
+    bench.run("util.wrapf.far", [&] { doNotOptimize(wrapf(in[i++] * 1e5f, -0.5f, 0.5f)); });
+    bench.run("util.wrap.int", [&] { doNotOptimize(wrap(int32_t(in[i++] * 1e6f), 0, 4000)); });
+    bench.run("util.wrap.int.pow2", [&] { doNotOptimize(wrap(int32_t(in[i++] * 1e6f), 0, 4096)); });
+    bench.run("util.centerHysteris", [&] { doNotOptimize(centerHysteris(in[i++], 0.1f)); });
+
+    static float frame[Inputs::N];
+    bench.run("util.mapConstrainf.x1024", [&] {
+        for (int n = 0; n < Inputs::N; n++)
+            frame[n] = mapConstrainf(in.values[n], -0.5f, 0.5f, 0, 1);
+        doNotOptimize(frame[0]);
+    });
+    bench.run("util.mapConstrainf.batch1024", [&] {
+        mapConstrainf(in.values, frame, Inputs::N, -0.5f, 0.5f, 0, 1);
+        doNotOptimize(frame[0]);
+    });
+
+    // -- timer wheel ------------------------------------------------------
+    // cost per tick must stay flat from 16 to 4000 pending timers
+    // (1-4 h at 1 ms ticks, none of them fires during the benchmark)
+    using Wheel        = TimerWheel<4096>;
+    auto      wheels   = std::unique_ptr<Wheel[]>(new Wheel[2]);
+    uint32_t  fired    = 0;
+    const int counts[] = {16, 4000};
+    for (int w = 0; w < 2; w++)
+        for (int n = 0; n < counts[w]; n++)
+        {
+            const uint32_t delay = 3600000 + uint32_t(random(0, 3 * 3600000));
+            wheels[w].start(wheels[w].create([&fired] { fired++; }), delay);
+        }
+    bench.run("timer_wheel.tick.16", [&] { wheels[0].tick(); });
+    bench.run("timer_wheel.tick.4000", [&] { wheels[1].tick(); });
+    doNotOptimize(fired);
+
+    const int restart_id = wheels[1].create(nullptr);
+    bench.run("timer_wheel.start_stop.4000", [&] {
+        wheels[1].start(restart_id, 1 + (i++ & 0xffff));
+        wheels[1].stop(restart_id);
+    });
+
+    // -- LED --------------------------------------------------------------
+    // virtual time is advanced by hand, each loop() call runs applyBrightness() once
+    util::led::Driver led(util::led::PWMConfig(2));
+    led.setup();
+    led.setAnimation(util::led::AnimationMode::BREATH);
+    bench.run("led.applyBrightness.breath", [&] {
+        host::clock::advance_ms(3);
+        led.loop();
+    });
+    led.setAnimation(util::led::AnimationMode::STATIC);
+    bench.run("led.applyBrightness.static", [&] {
+        led.set(in[i++] * 0.5f + 0.5f);
+        host::clock::advance_ms(3);
+        led.loop();
+    });
+    // settled output: no PWM write, no callback
+    led.set(0.5f);
+    led.setDirectly(0.5f);
+    bench.run("led.applyBrightness.idle", [&] {
+        host::clock::advance_ms(3);
+        led.loop();
+    });
+
+    // 16 channels, half static / half animated: 16 Drivers vs. one Group frame
+    static const util::led::AnimationMode modes[4] = {util::led::AnimationMode::STATIC,
+                                                      util::led::AnimationMode::BREATH,
+                                                      util::led::AnimationMode::STATIC,
+                                                      util::led::AnimationMode::WAVE};
+    std::vector<std::unique_ptr<util::led::Driver>> drivers;
+    util::led::Group<16>                            group;
+    for (int n = 0; n < 16; n++)
+    {
+        drivers.push_back(std::make_unique<util::led::Driver>(util::led::PWMConfig(uint8_t(10 + n))));
+        drivers[n]->setup();
+        drivers[n]->setAnimation(modes[n & 3]);
+        group.setup(n, util::led::PWMConfig(uint8_t(30 + n)));
+        group.setAnimation(n, modes[n & 3]);
+    }
+    bench.run("led.driver.update.x16", [&] {
+        host::clock::advance_ms(3);
+        for (auto& driver : drivers)
+            driver->update();
+    });
+    bench.run("led.group16.update", [&] {
+        host::clock::advance_ms(3);
+        group.update();
+    });
+}
+
+/**
+ * @brief PIDBank<N> against N scalar PIDs fed the same random inputs
+ *
+ * Random gains, targets and derivative cutoffs per channel. Builds without
+ * FMA contraction give identical results; the compiler may fuse multiply/add
+ * differently in the two loops otherwise (ESP32 has madd.s), so the check
+ * allows `tolerance` relative to the output.
+ * @return false (and prints the worst channel) if any output differs more
+ */
+inline bool checkPidBank(int samples = 100000, float tolerance = 1e-5f)
+{
+    static constexpr int N = 8;
+
+    PID        pids[N];
+    PIDBank<N> bank;
+    randomSeed(42);
+    for (int n = 0; n < N; n++)
+    {
+        const float kp     = float(random(0, 3000)) / 1000.0f;
+        const float ki     = float(random(0, 2000)) / 1000.0f;
+        const float kd     = float(random(0, 200)) / 1000.0f;
+        const float target = float(random(-1000, 1000)) / 1000.0f;
+        const float cutoff = (n & 1) ? float(random(5, 200)) : 0.0f; // 0 = legacy factor
+
+        pids[n].setParams(kp, ki, kd);
+        pids[n].setTarget(target);
+        pids[n].setDerivativeFilter(PIDDerivativeFilterType::ONE_POLE, cutoff);
+        bank.setParams(n, kp, ki, kd);
+        bank.setTarget(n, target);
+        bank.setDerivativeCutoff(n, cutoff);
+    }
+
+    float in[N], out[N];
+    float worst         = 0;
+    int   worst_channel = 0;
+    for (int s = 0; s < samples; s++)
+    {
+        for (int n = 0; n < N; n++)
+            in[n] = float(random(-10000, 10000)) / 10000.0f;
+        bank.process(in, out);
+        for (int n = 0; n < N; n++)
+        {
+            const float expected = pids[n].process(in[n]);
+            const float error    = std::fabs(out[n] - expected) / std::max(1.0f, std::fabs(expected));
+            if (error > worst)
+            {
+                worst         = error;
+                worst_channel = n;
+            }
+        }
+    }
+
+    printf("checkPidBank: %d samples x %d channels, worst relative difference %g\n", samples, N, worst);
+    if (worst > tolerance)
+    {
+        printf("ERROR in checkPidBank: channel %d differs by %g (tolerance %g)\n", worst_channel, worst, tolerance);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Buffer helpers (basics_batch.h) against the scalar functions in basics.h
+ *
+ * Random inputs (in and out of range) and parameters, every length from 0
+ * to 67 so the SIMD body and each tail length run, misaligned buffers and
+ * in place. Results must be equal to the scalar ones (no tolerance).
+ * @return false (and prints the first mismatch) otherwise
+ */
+inline bool checkBatchHelpers(int rounds = 200)
+{
+    static constexpr int MAX_N = 67;
+    float                in[MAX_N + 1], out[MAX_N + 1], expected[MAX_N];
+
+    auto value = [] { return float(random(-30000, 30000)) / 10000.0f; }; // -3..3
+    bool ok    = true;
+    auto compare = [&](const char* name, size_t n, const float* result) {
+        for (size_t i = 0; i < n && ok; i++)
+            if (!(result[i] == expected[i]))
+            {
+                printf("ERROR in checkBatchHelpers: %s n=%u [%u] = %g, scalar %g\n",
+                       name,
+                       unsigned(n),
+                       unsigned(i),
+                       result[i],
+                       expected[i]);
+                ok = false;
+            }
+    };
+
+    randomSeed(3);
+    for (int r = 0; r < rounds && ok; r++)
+    {
+        const float a = value(), b = value(), c = value(), d = value();
+        const float lo = std::min(a, b), hi = std::max(a, b) + 0.01f;
+        const float zone = float(random(0, 9000)) / 10000.0f;
+
+        for (size_t n = 0; n <= MAX_N && ok; n++)
+        {
+            // offset 1: unaligned for the SIMD loads/stores
+            float* src = in + (r & 1);
+            for (size_t i = 0; i < n; i++)
+                src[i] = value();
+
+#define UTIL_CHECK_BATCH(name, scalar_call, batch_call)      \
+    for (size_t i = 0; i < n; i++)                          \
+    {                                                       \
+        const float x = src[i];                             \
+        expected[i]   = scalar_call;                        \
+    }                                                       \
+    batch_call;                                             \
+    compare(name, n, out);
+
+            UTIL_CHECK_BATCH("mapf", mapf(x, a, hi, c, d), mapf(src, out, n, a, hi, c, d))
+            UTIL_CHECK_BATCH("mapConstrainf", mapConstrainf(x, lo, hi, c, d), mapConstrainf(src, out, n, lo, hi, c, d))
+            UTIL_CHECK_BATCH("clipf", clipf(x, lo, hi), clipf(src, out, n, lo, hi))
+            UTIL_CHECK_BATCH("normf", normf(x, lo, hi), normf(src, out, n, lo, hi))
+            UTIL_CHECK_BATCH("wrapf", wrapf(x, lo, hi), wrapf(src, out, n, lo, hi))
+            UTIL_CHECK_BATCH("centerHysteris", centerHysteris(x, zone), centerHysteris(src, out, n, zone))
+            UTIL_CHECK_BATCH("convert_zero_zone", convert_zero_zone(x, zone), convert_zero_zone(src, out, n, zone))
+#undef UTIL_CHECK_BATCH
+
+            // in place
+            for (size_t i = 0; i < n; i++)
+                expected[i] = mapConstrainf(src[i], lo, hi, c, d);
+            mapConstrainf(src, src, n, lo, hi, c, d);
+            compare("mapConstrainf in place", n, src);
+
+#if defined(__cpp_lib_span)
+            for (size_t i = 0; i < n; i++)
+                expected[i] = clipf(in[i], lo, hi);
+            clipf(std::span<const float>(in, n), std::span<float>(out, n), lo, hi);
+            compare("clipf span", n, out);
+#endif
+        }
+    }
+
+    printf("checkBatchHelpers: %s\n", ok ? "all equal to the scalar functions" : "FAILED");
+    return ok;
+}
+
+/**
+ * @brief Fixed-point PID / filter / map helpers against their float versions
+ *
+ * Same random input sequence through both, worst absolute difference per
+ * function: PID_T<q16_16>, mapConstrainf and clipf in q16_16 and q15,
+ * simpleFilterf in q15, simpleFilterWrapf in q16_16.
+ * @return false (and prints the function) if an error bound is exceeded
+ */
+inline bool checkFixedPoint(int samples = 100000)
+{
+    struct Case
+    {
+        const char* name;
+        float       bound;
+        float       worst;
+    };
+    Case cases[] = {
+        {"PID_T<q16_16>", 1e-2f, 0},
+        {"mapConstrainf<q16_16> 0..255", 4e-3f, 0},
+        {"mapConstrainf<q15>", 2e-4f, 0},
+        {"clipf<q15>", 4e-5f, 0},
+        {"simpleFilterf<q15>", 1.5e-3f, 0}, // stops ~2 LSB / filterFactor short
+        {"simpleFilterWrapf<q16_16>", 1e-4f, 0},
+    };
+    auto track = [&](int c, float fixed_value, float float_value) {
+        cases[c].worst = std::max(cases[c].worst, std::fabs(fixed_value - float_value));
+    };
+
+    PID           pid_f;
+    PID_T<q16_16> pid_q;
+    pid_f.setParams(1.2f, 0.5f, 0.05f);
+    pid_q.setParams(1.2f, 0.5f, 0.05f);
+    pid_f.setTarget(0.25f);
+    pid_q.setTarget(0.25f);
+
+    float  filter_f = 0, wrap_f = 0, step = 0;
+    q15    filter_q = 0;
+    q16_16 wrap_q   = 0;
+
+    randomSeed(7);
+    for (int s = 0; s < samples; s++)
+    {
+        const float x = float(random(-10000, 10000)) / 10000.0f; // [-1, 1)
+
+        track(0, float(pid_q.process(q16_16(x))), pid_f.process(x));
+        track(1, float(mapConstrainf(q16_16(x), -0.5f, 0.5f, 0, 255)), mapConstrainf(x, -0.5f, 0.5f, 0, 255));
+        track(2, float(mapConstrainf(q15(x), -0.5f, 0.5f, 0, 0.75f)), mapConstrainf(x, -0.5f, 0.5f, 0, 0.75f));
+        track(3, float(clipf(q15(x), -0.25f, 0.5f)), clipf(x, -0.25f, 0.5f));
+
+        // step responses, a new target every 500 samples; lastStep 0: the
+        // snap to the target may come one sample apart, that is a 0.01 jump
+        if (s % 500 == 0)
+            step = x * 0.9f;
+        simpleFilterf(filter_f, step, 0.05f, 0.0f);
+        simpleFilterf(filter_q, q15(step), 0.05f, 0.0f);
+        track(4, float(filter_q), filter_f);
+
+        const float phase = x * 0.5f + 0.5f; // 0..1, wraps
+        simpleFilterWrapf(wrap_f, phase, 0.2f);
+        simpleFilterWrapf(wrap_q, q16_16(phase), 0.2f);
+        track(5, float(wrap_q), wrap_f);
+    }
+
+    bool ok = true;
+    for (const Case& c : cases)
+    {
+        printf("checkFixedPoint: %-30s max error %.2e (bound %.1e)\n", c.name, c.worst, c.bound);
+        if (!(c.worst <= c.bound))
+        {
+            printf("ERROR in checkFixedPoint: %s exceeds %g\n", c.name, c.bound);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief util::led::Driver::set() must not touch the heap
+ *
+ * Needs allocation counting (HOST_COUNT_ALLOCATIONS in main.cpp, see alloc_counter.h).
+ * @return false (and prints the count) if any call allocated, or if counting is off
+ */
+inline bool checkLedAllocations(uint32_t calls = 1000000)
+{
+    if (!host::alloc::hooked)
+    {
+        printf("ERROR in util::bench::checkLedAllocations: allocation counting off (define HOST_COUNT_ALLOCATIONS in main.cpp)\n");
+        return false;
+    }
+
+    util::led::Driver led(util::led::PWMConfig(2));
+    led.setup();
+
+    host::alloc::Scope scope;
+    for (uint32_t i = 0; i < calls; i++)
+    {
+        led.set(float(i & 0xff) / 255.0f);
+        if ((i & 0xff) == 0)
+        {
+            host::clock::advance_ms(3);
+            led.loop();
+        }
+    }
+    // switching animations is in place as well
+    led.setAnimation(util::led::AnimationMode::BREATH);
+    led.setAnimation(util::led::AnimationMode::RANDOM, {util::led::AnimationMode::RANDOM, 2.0f});
+    led.setAnimation(util::led::AnimationMode::STATIC);
+
+    if (scope.allocations())
+    {
+        printf("ERROR in checkLedAllocations: %u heap allocations in %u set() calls\n",
+               unsigned(scope.allocations()),
+               unsigned(calls));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Average accuracy of Driver::setDithering() at 8 bit PWM
+ *
+ * Holds each brightness of a slow fade over the bottom of the gamma curve
+ * for `ticks` loop ticks and compares the average written duty with the
+ * exact (float) duty. Prints the worst error as effective bits, with and
+ * without dithering.
+ * @return false if dithering reaches less than `min_bits`
+ */
+inline bool checkLedDithering(int ticks = 1024, float min_bits = 14.0f)
+{
+    static constexpr uint8_t PIN    = 3;
+    static constexpr int     LEVELS = 200;
+
+    float worst[2] = {};
+    for (int dither = 0; dither < 2; dither++)
+    {
+        util::led::Driver led{util::led::PWMConfig(PIN)};
+        led.setup();
+        led.setDithering(dither);
+
+        for (int l = 1; l <= LEVELS; l++)
+        {
+            const float brightness = 0.3f * float(l) / LEVELS; // 0..0.3 is 0..~18 steps at gamma 2.2
+            led.setDirectly(brightness);
+            const float exact = util::lut::powf(brightness, 2.2f);
+
+            uint64_t sum = 0;
+            for (int t = 0; t < ticks; t++)
+            {
+                host::clock::advance_ms(3);
+                led.loop();
+                sum += host::pins::get(PIN).duty;
+            }
+            const float average = float(sum) / float(ticks) / 255.0f;
+            worst[dither]       = std::max(worst[dither], std::fabs(average - exact));
+        }
+    }
+
+    const float plain_bits    = -log2f(worst[0]);
+    const float dithered_bits = -log2f(worst[1]);
+    printf("checkLedDithering: 8 bit PWM, average over %d ticks: %.1f bits plain, %.1f bits dithered\n",
+           ticks,
+           plain_bits,
+           dithered_bits);
+    if (dithered_bits < min_bits)
+    {
+        printf("ERROR in checkLedDithering: %.1f effective bits, expected %.1f\n", dithered_bits, min_bits);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief util::Scheduler with tasks re-enabled while run() holds them
+ *
+ * A task that disables and re-enables itself in its callback, and a period 0
+ * task toggled by another task, must run exactly once per run() and be
+ * queued only once (Scheduler<2>, a second push would write past the heap;
+ * build with -fsanitize=address,undefined to see it).
+ * @return false (and prints the run counts) if a task ran more or less often
+ */
+inline bool checkScheduler(int ticks = 100)
+{
+    util::Scheduler<2> self_toggle;
+    int                self_id   = -1;
+    int                self_runs = 0;
+    self_id = self_toggle.add("self", 1000, [&] {
+        self_runs++;
+        self_toggle.enable(self_id, false);
+        self_toggle.enable(self_id, true);
+    });
+
+    util::Scheduler<2> other_toggle;
+    int                every_runs = 0;
+    const int          every_id   = other_toggle.add("every", 0, [&] { every_runs++; });
+    other_toggle.add("toggle", 1000, [&] {
+        other_toggle.enable(every_id, false);
+        other_toggle.enable(every_id, true);
+    });
+
+    for (int t = 0; t < ticks; t++)
+    {
+        host::clock::advance_us(1000);
+        self_toggle.run();
+        other_toggle.run();
+    }
+
+    if (self_runs != ticks || every_runs != ticks)
+    {
+        printf("ERROR in checkScheduler: %d ticks, self toggling task ran %d times, toggled period 0 task %d times\n",
+               ticks,
+               self_runs,
+               every_runs);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief util::TimerWheel timers that release themselves from their callback
+ *
+ * A periodic timer that stops after 3 runs and a one-shot from create() that
+ * releases itself both read their captures after release() (build with
+ * -fsanitize=address to see a callback destroyed while it runs).
+ * @return false if a timer ran too often or was not returned to the pool
+ */
+inline bool checkTimerWheel()
+{
+    util::TimerWheel<4> timers;
+
+    int       runs     = 0;
+    const int limit    = 3;
+    int       periodic = -1;
+    periodic           = timers.create([&, limit] {
+        if (runs + 1 == limit)
+            timers.release(periodic);
+        runs++; // the captures are read after release()
+    });
+    timers.start(periodic, 1, 1);
+
+    int one_shot      = -1;
+    int one_shot_runs = 0;
+    one_shot          = timers.create([&] {
+        timers.release(one_shot);
+        one_shot_runs++;
+    });
+    timers.start(one_shot, 2);
+
+    timers.advance(10);
+
+    if (runs != limit || one_shot_runs != 1 || timers.size() != 0)
+    {
+        printf("ERROR in checkTimerWheel: periodic ran %d times (expected %d), one-shot %d times, %d timers left\n",
+               runs,
+               limit,
+               one_shot_runs,
+               timers.size());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief util::led::Group<N> against N util::led::Driver objects, per mode
+ *
+ * Same configs (different speed, range and period per channel), same
+ * virtual clock. STATIC steps the targets through the default filter, the
+ * animated modes run with the filter off: a tiny phase difference would
+ * otherwise move the filter's final snap by a tick. RANDOM is left out
+ * (the two draw random() at different times).
+ * @return false (and prints the mode) if a duty differs by more than
+ *         `tolerance` LSB (8 bit, gamma table + float phase)
+ */
+inline bool checkLedGroup(int ticks = 3000, int tolerance = 1)
+{
+    static constexpr int N = 4;
+    using util::led::AnimationMode;
+
+    util::led::Timeline timeline;
+    timeline.add(0, 0.0f);
+    timeline.add(1500, 0.8f, util::led::Timeline::Curve::LOG);
+    timeline.add(2500, 0.2f, util::led::Timeline::Curve::EASE);
+    timeline.setLoop(true);
+
+    static const AnimationMode MODES[] = {
+        AnimationMode::STATIC, AnimationMode::BREATH, AnimationMode::PULSE, AnimationMode::WAVE, AnimationMode::TIMELINE};
+    static const char* const NAMES[] = {"STATIC", "BREATH", "PULSE", "WAVE", "TIMELINE"};
+
+    bool ok = true;
+    for (int m = 0; m < 5; m++)
+    {
+        const AnimationMode mode = MODES[m];
+
+        util::led::Group<N>                group;
+        std::unique_ptr<util::led::Driver> drivers[N];
+        for (int n = 0; n < N; n++)
+        {
+            drivers[n].reset(new util::led::Driver{util::led::PWMConfig(uint8_t(20 + n))});
+            drivers[n]->setup();
+            group.setup(n, util::led::PWMConfig(uint8_t(40 + n)));
+
+            const util::led::AnimationConfig config(mode, 1.0f + 0.5f * n, 0.1f * n, 1.0f - 0.1f * n, 1000 + 300 * n);
+            if (mode == AnimationMode::TIMELINE)
+            {
+                drivers[n]->setTimeline(timeline, config);
+                group.setTimeline(n, timeline, config);
+            }
+            else
+            {
+                drivers[n]->setAnimation(mode, config);
+                group.setAnimation(n, mode, config);
+            }
+            if (mode != AnimationMode::STATIC)
+                drivers[n]->setFilterTimeConstant(0);
+        }
+        if (mode != AnimationMode::STATIC)
+            group.setFilterTimeConstant(0);
+
+        // first update starts both clocks
+        group.update();
+        for (int n = 0; n < N; n++)
+            drivers[n]->update();
+
+        int worst = 0;
+        for (int t = 0; t < ticks; t++)
+        {
+            host::clock::advance_ms(3);
+            if (mode == AnimationMode::STATIC && t % 200 == 0)
+                for (int n = 0; n < N; n++)
+                {
+                    const float target = float((t / 200 * 37 + n * 11) % 100) / 100.0f;
+                    drivers[n]->set(target);
+                    group.set(n, target);
+                }
+            for (int n = 0; n < N; n++)
+                drivers[n]->update();
+            group.update();
+
+            for (int n = 0; n < N; n++)
+                worst = std::max(worst, std::abs(int(host::pins::get(20 + n).duty) - int(group.getDuty(n))));
+        }
+        if (worst > tolerance)
+        {
+            printf("ERROR in checkLedGroup: %s differs by %d LSB from Driver (tolerance %d)\n", NAMES[m], worst, tolerance);
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+} // namespace bench
+} // namespace util
@@ -0,0 +1,246 @@
+#pragma once
+
+/**
+ * @file concurrency_suite.h
+ * @brief Multithreaded stress check and throughput benchmarks for concurrency.h (host only, -pthread)
+ *
+ * Usage (native env main.cpp):
+ *
+ * int main()
+ * {
+ *     if (!util::bench::stressConcurrency())
+ *         return 1;
+ *     util::bench::Runner bench(1000000);
+ *     util::bench::runConcurrencySuite(bench);
+ *     bench.print();
+ *     return 0;
+ * }
+ */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "../benchmark.h"
+#include "../concurrency.h"
+
+namespace util {
+namespace bench {
+
+// waiting side: yield first, then sleep so that the other thread gets the
+// core even on single core hosts (where yield alone may return right away)
+struct Backoff
+{
+    uint32_t spins = 0;
+
+    void wait()
+    {
+        if (++spins < 16)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(std::chrono::microseconds(1));
+    }
+    void reset() { spins = 0; }
+};
+
+// all fields derived from seq, a torn copy shows up as a mismatch
+struct StressValue
+{
+    uint32_t seq;
+    uint32_t twice;
+    float    as_float;
+    uint32_t inverted;
+
+    static StressValue make(uint32_t seq) { return {seq, seq * 2, float(seq), ~seq}; }
+    bool consistent() const { return twice == seq * 2 && as_float == float(seq) && inverted == ~seq; }
+};
+
+/**
+ * @brief Producer and consumer thread hammer each primitive
+ * @return false (and prints what failed) on lost, reordered or torn values
+ */
+inline bool stressConcurrency(uint32_t items = 1000000)
+{
+    bool ok = true;
+
+    // SpscQueue: every item arrives, in order
+    {
+        static SpscQueue<StressValue, 64> queue;
+        uint32_t                          errors = 0;
+        std::thread                       consumer([&] {
+            StressValue value;
+            Backoff     backoff;
+            for (uint32_t expected = 0; expected < items;)
+                if (queue.pop(value))
+                {
+                    if (value.seq != expected || !value.consistent())
+                        errors++;
+                    expected++;
+                    backoff.reset();
+                }
+                else
+                    backoff.wait();
+        });
+        Backoff backoff;
+        for (uint32_t i = 0; i < items;)
+            if (queue.push(StressValue::make(i)))
+            {
+                i++;
+                backoff.reset();
+            }
+            else
+                backoff.wait();
+        consumer.join();
+        if (errors)
+        {
+            printf("ERROR in stressConcurrency: SpscQueue %u lost/reordered/torn items\n", unsigned(errors));
+            ok = false;
+        }
+    }
+
+    // TripleBuffer / SeqLock: values are consistent and never go back in time
+    {
+        static TripleBuffer<StressValue> triple(StressValue::make(0));
+        std::atomic<bool>                done{false};
+        uint32_t                         errors = 0;
+        uint32_t                         reads  = 0;
+        std::thread                      reader([&] {
+            uint32_t last = 0;
+            while (!done)
+            {
+                StressValue value;
+                if (!triple.read(value))
+                    continue;
+                if (!value.consistent() || value.seq < last)
+                    errors++;
+                last = value.seq;
+                reads++;
+            }
+        });
+        for (uint32_t i = 1; i <= items; i++)
+            triple.write(StressValue::make(i));
+        done = true;
+        reader.join();
+        if (errors)
+        {
+            printf("ERROR in stressConcurrency: TripleBuffer %u torn/stale of %u reads\n", unsigned(errors), unsigned(reads));
+            ok = false;
+        }
+    }
+
+    {
+        static SeqLock<StressValue> seqlock(StressValue::make(0));
+        std::atomic<bool>           done{false};
+        std::atomic<uint32_t>       errors{0};
+        auto                        read = [&] {
+            uint32_t last = 0;
+            Backoff  backoff;
+            while (!done)
+            {
+                StressValue value;
+                if (!seqlock.tryLoad(value))
+                {
+                    backoff.wait(); // writer active or preempted mid-store
+                    continue;
+                }
+                backoff.reset();
+                if (!value.consistent() || value.seq < last)
+                    errors++;
+                last = value.seq;
+            }
+        };
+        std::thread reader_a(read);
+        std::thread reader_b(read);
+        for (uint32_t i = 1; i <= items; i++)
+            seqlock.store(StressValue::make(i));
+        done = true;
+        reader_a.join();
+        reader_b.join();
+        if (errors)
+        {
+            printf("ERROR in stressConcurrency: SeqLock %u torn/stale reads\n", unsigned(errors.load()));
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+/**
+ * @brief Cross-thread throughput: ns per item with a second thread on the other end
+ *
+ * The .threaded numbers are only meaningful with at least 2 host cores.
+ */
+inline void runConcurrencySuite(Runner& bench)
+{
+    std::atomic<bool> done{false};
+
+    {
+        static SpscQueue<StressValue, 1024> queue;
+        std::thread                         consumer([&] {
+            StressValue value;
+            while (!done)
+                while (queue.pop(value))
+                    doNotOptimize(value);
+        });
+        uint32_t i = 0;
+        bench.run("spsc_queue.push.threaded", [&] {
+            while (!queue.push(StressValue::make(i)))
+            {
+            }
+            i++;
+        });
+        done = true;
+        consumer.join();
+    }
+
+    done = false;
+    {
+        static TripleBuffer<StressValue> triple;
+        std::thread                      reader([&] {
+            StressValue value;
+            while (!done)
+                if (triple.read(value))
+                    doNotOptimize(value);
+        });
+        uint32_t i = 0;
+        bench.run("triple_buffer.write.threaded", [&] { triple.write(StressValue::make(i++)); });
+        done = true;
+        reader.join();
+    }
+
+    done = false;
+    {
+        static SeqLock<StressValue> seqlock;
+        std::thread                 reader([&] {
+            StressValue value;
+            Backoff     backoff;
+            while (!done)
+                if (seqlock.tryLoad(value))
+                {
+                    doNotOptimize(value);
+                    backoff.reset();
+                }
+                else
+                    backoff.wait();
+        });
+        uint32_t i = 0;
+        bench.run("seqlock.store.threaded", [&] { seqlock.store(StressValue::make(i++)); });
+        bench.run("seqlock.load", [&] { doNotOptimize(seqlock.load()); });
+        done = true;
+        reader.join();
+    }
+
+    // uncontended baselines
+    static SpscQueue<StressValue, 1024> queue;
+    StressValue                         value;
+    uint32_t                            i = 0;
+    bench.run("spsc_queue.push_pop", [&] {
+        queue.push(StressValue::make(i++));
+        queue.pop(value);
+        doNotOptimize(value);
+    });
+}
+
+} // namespace bench
+} // namespace util
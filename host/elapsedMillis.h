@@ -0,0 +1,82 @@
+#pragma once
+
+// Host-side stand-in for https://github.com/pfeerick/elapsedMillis
+// driven by the virtual clock in Arduino.h.
+
+#include "Arduino.h"
+
+class elapsedMillis
+{
+private:
+    uint32_t ms; // 32 bit like on target, wraps with millis()
+
+public:
+    elapsedMillis(void) { ms = millis(); }
+    elapsedMillis(unsigned long val) { ms = millis() - val; }
+    elapsedMillis(const elapsedMillis& orig) { ms = orig.ms; }
+    operator unsigned long() const { return uint32_t(millis() - ms); }
+    elapsedMillis& operator=(const elapsedMillis& rhs)
+    {
+        ms = rhs.ms;
+        return *this;
+    }
+    elapsedMillis& operator=(unsigned long val)
+    {
+        ms = millis() - val;
+        return *this;
+    }
+    elapsedMillis& operator-=(unsigned long val)
+    {
+        ms += val;
+        return *this;
+    }
+    elapsedMillis& operator+=(unsigned long val)
+    {
+        ms -= val;
+        return *this;
+    }
+    elapsedMillis operator-(int val) const
+    {
+        elapsedMillis r(*this);
+        r.ms += val;
+        return r;
+    }
+    elapsedMillis operator+(int val) const
+    {
+        elapsedMillis r(*this);
+        r.ms -= val;
+        return r;
+    }
+};
+
+class elapsedMicros
+{
+private:
+    uint32_t us; // 32 bit like on target, wraps with micros()
+
+public:
+    elapsedMicros(void) { us = micros(); }
+    elapsedMicros(unsigned long val) { us = micros() - val; }
+    elapsedMicros(const elapsedMicros& orig) { us = orig.us; }
+    operator unsigned long() const { return uint32_t(micros() - us); }
+    elapsedMicros& operator=(const elapsedMicros& rhs)
+    {
+        us = rhs.us;
+        return *this;
+    }
+    elapsedMicros& operator=(unsigned long val)
+    {
+        us = micros() - val;
+        return *this;
+    }
+    elapsedMicros& operator-=(unsigned long val)
+    {
+        us += val;
+        return *this;
+    }
+    elapsedMicros& operator+=(unsigned long val)
+    {
+        us -= val;
+        return *this;
+    }
+};
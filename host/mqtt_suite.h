@@ -0,0 +1,159 @@
+#pragma once
+
+/**
+ * @file mqtt_suite.h
+ * @brief MQTT message routing / publish throughput with many components (host only)
+ *
+ * Messages go the whole way: raw PUBLISH packets are pushed into the
+ * loopback client and read by PubSubClient in MQTT::loop(), so the numbers
+ * include packet parsing, topic lookup, JSON parsing and the callback.
+ * Heap allocations per message are reported when main.cpp enables
+ * counting (see alloc_counter.h).
+ *
+ * Usage (native env main.cpp, needs PubSubClient and ArduinoJson):
+ *
+ * int main()
+ * {
+ *     util::bench::Runner bench;
+ *     util::bench::runMqttSuite(bench, 300);
+ *     bench.print();
+ *     return 0;
+ * }
+ */
+
+#include <string>
+#include <vector>
+
+#include "../benchmark.h"
+#include "../interface/mqtt.h"
+#include "alloc_counter.h"
+
+namespace util {
+namespace bench {
+
+// MQTT 3.1.1 PUBLISH, QoS 0
+inline std::string mqttPublishPacket(const String& topic, const char* payload)
+{
+    const size_t topic_length = topic.length();
+    size_t       remaining    = 2 + topic_length + strlen(payload);
+
+    std::string packet(1, char(0x30));
+    do
+    {
+        uint8_t digit = remaining % 128;
+        remaining /= 128;
+        if (remaining > 0)
+            digit |= 0x80;
+        packet += char(digit);
+    } while (remaining > 0);
+    packet += char(topic_length >> 8);
+    packet += char(topic_length & 0xFF);
+    packet += topic.c_str();
+    packet += payload;
+    return packet;
+}
+
+inline void runMqttSuite(Runner& bench, int components = 300)
+{
+    host::LoopbackClient client;
+    MQTT                 mqtt("127.0.0.1", 1883, client, "bench");
+    mqtt.setVerbose(false);
+
+    std::vector<String> names;
+    for (int c = 0; c < components; c++)
+    {
+        names.push_back(String("light_") + String(c));
+        mqtt.addLight(names.back());
+    }
+
+    uint32_t changes = 0;
+    mqtt.setLightChangeCallback([&](const String&, float) { changes++; });
+
+    mqtt.isRechableAndActive();
+    mqtt.setup();
+    client.inject(std::string("\x20\x02\x00\x00", 4)); // CONNACK
+    for (int i = 0; i < 4 && !mqtt.connected(); i++)
+        mqtt.loop();
+    mqtt.loop(); // subscribe
+    if (!mqtt.connected())
+    {
+        printf("ERROR in runMqttSuite: not connected\n");
+        return;
+    }
+
+    std::vector<std::string> commands;
+    for (const auto& name : names)
+        commands.push_back(mqttPublishPacket(String("bench/light/") + name + "/set", "{\"state\":\"ON\",\"brightness\":128}"));
+    const std::string foreign = mqttPublishPacket("other_device/light/light_1/set", "{\"state\":\"ON\"}");
+
+    uint32_t i = 0;
+    char     label[40];
+
+    snprintf(label, sizeof(label), "mqtt.route.command.%d", components);
+    const float command_ns = bench.run(label, [&] {
+        client.inject(commands[i++ % commands.size()]);
+        mqtt.loop();
+    });
+
+    snprintf(label, sizeof(label), "mqtt.route.unknown.%d", components);
+    const float unknown_ns = bench.run(label, [&] {
+        client.inject(foreign);
+        mqtt.loop();
+    });
+
+    // control loop side of a sensor: most calls end in the deadband
+    const int position = mqtt.addSensor("position", "mm", 0.05f, 100);
+    float     angle    = 0;
+    bench.run("mqtt.publishValue.deadband", [&] {
+        angle += 0.001f;
+        mqtt.publishValue(position, sinf(angle));
+    });
+
+    snprintf(label, sizeof(label), "mqtt.publishLight.%d", components);
+    bench.run(label, [&] {
+        mqtt.publishLight(names[i++ % names.size()], 0.5f);
+        client.tx.clear();
+    });
+
+    doNotOptimize(changes);
+    printf("mqtt: %.0f commands/s, %.0f foreign messages/s (%d components)\n",
+           1e9f / command_ns,
+           1e9f / unknown_ns,
+           components);
+
+    if (!host::alloc::hooked)
+    {
+        printf("mqtt: allocation counting off (define HOST_COUNT_ALLOCATIONS in main.cpp)\n");
+        return;
+    }
+
+    // steady state: every component published and commanded once before
+    static constexpr int ROUNDS = 1000;
+    mqtt.setPublishInterval(0);
+    for (const auto& light : names)
+        mqtt.publishLight(light, 1.0f);
+    for (int n = 0; n < components; n++)
+        mqtt.loop();
+
+    host::alloc::Scope publish;
+    for (int n = 0; n < ROUNDS; n++)
+    {
+        mqtt.publishLight(names[n % names.size()], float(n % 256) / 255.0f);
+        mqtt.loop(); // sends it
+        client.tx.clear();
+    }
+    const float publish_allocations = float(publish.allocations()) / ROUNDS;
+
+    host::alloc::Scope command;
+    for (int n = 0; n < ROUNDS; n++)
+    {
+        client.inject(commands[n % commands.size()]);
+        mqtt.loop();
+    }
+    const float command_allocations = float(command.allocations()) / ROUNDS;
+
+    printf("mqtt: %.2f heap allocations per publish, %.2f per command\n", publish_allocations, command_allocations);
+}
+
+} // namespace bench
+} // namespace util
@@ -0,0 +1,154 @@
+#pragma once
+
+/**
+ * @file timeline_suite.h
+ * @brief util::led::Timeline curves and server/timeline_file.h loading (host only)
+ *
+ * Usage (native env main.cpp, needs ArduinoJson):
+ *
+ * int main()
+ * {
+ *     return util::bench::checkTimeline() ? 0 : 1;
+ * }
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "../led_timeline.h"
+#include "../server/timeline_file.h"
+
+namespace util {
+namespace bench {
+
+/**
+ * @brief Timeline against the exact curves, and a JSON round trip
+ *
+ * - rising and falling LOG within `tolerance` of the step from the exact
+ *   curve (falling is mirrored: fast first, slow at the low end)
+ * - playback with a cursor is monotonic per segment and equals evaluate()
+ *   without one
+ * - STEP holds until the keyframe, values before the start and after the
+ *   end are the first/last keyframe
+ * - loadTimeline() from the in-memory SPIFFS gives the same values as add(),
+ *   an unknown curve name and a missing file fail
+ * @return false (and prints the case) on the first mismatch
+ */
+inline bool checkTimeline(float tolerance = 1.5e-3f)
+{
+    using Curve = util::led::Timeline::Curve;
+
+    // 0.2 -> 1.0 -> 0.2 in LOG, hold, STEP down, EASE up
+    util::led::Timeline timeline;
+    timeline.add(1000, 0.2f);
+    timeline.add(2000, 1.0f, Curve::LOG);
+    timeline.add(3000, 0.2f, Curve::LOG);
+    timeline.add(4000, 0.6f, Curve::STEP);
+    timeline.add(5000, 1.0f, Curve::EASE);
+
+    // exact LOG shape 0..1, as documented: (2^(5u) - 1) / 31
+    const auto exact = [](float u) { return (std::exp2(5.0f * u) - 1.0f) / 31.0f; };
+
+    float rising = 0, falling = 0;
+    for (int i = 0; i <= 1000; i++)
+    {
+        const float u = float(i) / 1000.0f;
+        rising        = std::max(rising, std::fabs(timeline.evaluate(1000.0f + i) - (0.2f + 0.8f * exact(u))) / 0.8f);
+        falling       = std::max(falling, std::fabs(timeline.evaluate(2000.0f + i) - (1.0f - 0.8f * (1.0f - exact(1.0f - u)))) / 0.8f);
+    }
+    if (rising > tolerance || falling > tolerance)
+    {
+        printf("ERROR in checkTimeline: LOG off the exact curve by %.1e rising, %.1e falling (tolerance %.1e)\n",
+               rising,
+               falling,
+               tolerance);
+        return false;
+    }
+    // mirrored: after 10% of a fade-down most of the step is gone
+    if (timeline.evaluate(2100.0f) > 0.8f)
+    {
+        printf("ERROR in checkTimeline: falling LOG at 10%% is %.3f, expected a fast start\n", timeline.evaluate(2100.0f));
+        return false;
+    }
+
+    // playback as a player does it, 3 ms ticks
+    uint16_t cursor = 0;
+    float    last   = timeline.evaluate(1000.0f);
+    for (float t = 1003.0f; t < 5000.0f; t += 3.0f)
+    {
+        const float value = timeline.evaluate(t, cursor);
+        if (value != timeline.evaluate(t))
+        {
+            printf("ERROR in checkTimeline: cursor at %.0f ms gives %f, without %f\n", t, value, timeline.evaluate(t));
+            return false;
+        }
+        const bool up   = t < 2000.0f || t >= 4000.0f;
+        const bool down = t >= 2000.0f && t < 3000.0f;
+        if ((up && value < last - 1e-6f) || (down && value > last + 1e-6f))
+        {
+            printf("ERROR in checkTimeline: not monotonic at %.0f ms (%f after %f)\n", t, value, last);
+            return false;
+        }
+        last = value;
+    }
+
+    struct Expected
+    {
+        float t_ms;
+        float value;
+    };
+    static const Expected VALUES[] = {
+        {0.0f, 0.2f},    // before the start
+        {3999.0f, 0.2f}, // STEP holds the previous value
+        {4000.0f, 0.6f}, // and jumps at the keyframe
+        {5000.0f, 1.0f}, // end
+        {9000.0f, 1.0f}, // after the end
+    };
+    for (const Expected& expected : VALUES)
+        if (std::fabs(timeline.evaluate(expected.t_ms) - expected.value) > 1e-6f)
+        {
+            printf("ERROR in checkTimeline: %.0f ms gives %f, expected %f\n",
+                   expected.t_ms,
+                   timeline.evaluate(expected.t_ms),
+                   expected.value);
+            return false;
+        }
+
+    // the same sequence from JSON
+    host::fs::files()["/timeline_check.json"] = R"({"loop": true, "keyframes": [
+        {"t": 1000, "v": 0.2},
+        {"t": 2000, "v": 1.0, "curve": "log"},
+        {"t": 3000, "v": 0.2, "curve": "log"},
+        {"t": 4000, "v": 0.6, "curve": "step"},
+        {"t": 5000, "v": 1.0, "curve": "ease"}]})";
+    util::led::Timeline loaded;
+    if (!loadTimeline(loaded, "/timeline_check.json") || !loaded.loops() || loaded.keyframes() != timeline.keyframes() ||
+        loaded.segments() != timeline.segments())
+    {
+        printf("ERROR in checkTimeline: /timeline_check.json not loaded as written\n");
+        return false;
+    }
+    for (float t = 0.0f; t <= 5500.0f; t += 7.0f)
+        if (std::fabs(loaded.evaluate(t) - timeline.evaluate(t)) > 1e-6f)
+        {
+            printf("ERROR in checkTimeline: loaded timeline gives %f at %.0f ms, add() %f\n",
+                   loaded.evaluate(t),
+                   t,
+                   timeline.evaluate(t));
+            return false;
+        }
+
+    host::fs::files()["/timeline_check.json"] = R"({"keyframes": [{"t": 0, "v": 0}, {"t": 100, "v": 1, "curve": "cubic"}]})";
+    const bool unknown_curve = loadTimeline(loaded, "/timeline_check.json");
+    host::fs::files().erase("/timeline_check.json");
+    const bool missing_file = loadTimeline(loaded, "/timeline_check.json");
+    if (unknown_curve || missing_file)
+    {
+        printf("ERROR in checkTimeline: loadTimeline() accepted %s\n", unknown_curve ? "an unknown curve" : "a missing file");
+        return false;
+    }
+    return true;
+}
+
+} // namespace bench
+} // namespace util
@@ -1,16 +1,134 @@
 #include "mqtt.h"
 #include "util.h"
 
+#include <algorithm>
+
+namespace {
+
+// serializeJson() writes a few bytes at a time, on a WiFiClient every write() is
+// a TCP send, so collect them into chunks first
+class ChunkedPrint : public Print
+{
+public:
+    explicit ChunkedPrint(Print& target) : _target(target) {}
+    ~ChunkedPrint() { flush(); }
+
+    size_t write(uint8_t c) override
+    {
+        if (_used == sizeof(_buffer))
+            flush();
+        _buffer[_used++] = c;
+        return 1;
+    }
+    size_t write(const uint8_t* data, size_t size) override
+    {
+        for (size_t i = 0; i < size; i++)
+            write(data[i]);
+        return size;
+    }
+    using Print::write;
+
+    void flush() override
+    {
+        if (_used)
+            _target.write(_buffer, _used);
+        _used = 0;
+    }
+
+private:
+    Print&  _target;
+    uint8_t _buffer[64];
+    size_t  _used = 0;
+};
+
+} // namespace
+
 MQTT::MQTT(const char* server, int port, const String& device_name)
-    : _server(server), _port(port), _client(*(new WiFiClient())), _device_name(device_name) {}
+    : MQTT(server, port, *(new WiFiClient()), device_name) {}
 
 MQTT::MQTT(const char* server, int port, Client& client, const String& device_name)
-    : _server(server), _port(port), _client(client), _device_name(device_name) {}
+    : _server(server), _port(port), _client(client), _probe(client), _device_name(device_name) {}
+
+const MQTT::PlatformInfo MQTT::PLATFORMS[] = {
+    {"light", &MQTT::lightCommand, &MQTT::lightDiscovery},
+    {"sensor", nullptr, &MQTT::sensorDiscovery},
+    {"binary_sensor", nullptr, nullptr},
+    {"switch", &MQTT::switchCommand, &MQTT::switchDiscovery},
+    {"number", &MQTT::numberCommand, &MQTT::numberDiscovery},
+};
 
-void MQTT::addComponent(const String& platform, const String& name)
+int MQTT::addComponent(const String& platform, const String& name)
 {
     printf("MQTT::addComponent( platform=%s, name=%s )\n", platform.c_str(), name.c_str());
-    _components.push_back({platform, name});
+
+    // the only string compare on the platform, everything later goes by Component::type
+    size_t type = 0;
+    while (type < size_t(Platform::COUNT) && platform != PLATFORMS[type].name)
+        type++;
+    if (type == size_t(Platform::COUNT))
+    {
+        printf("ERROR in MQTT::addComponent: unknown platform %s\n", platform.c_str());
+        return -1;
+    }
+
+    Component component;
+    component.platform            = platform;
+    component.type                = Platform(type);
+    component.name                = name;
+    component.state_topic         = getBaseTopic(component) + "/state";
+    component.command_topic       = getBaseTopic(component) + "/set";
+    component.publish_interval_ms = _publish_interval_ms;
+    _components.push_back(component);
+
+    const uint16_t index = uint16_t(_components.size() - 1);
+    if (PLATFORMS[type].command)
+        addRoute(_command_routes, component.command_topic, index);
+    addRoute(_name_routes, component.name, index);
+    return index;
+}
+
+int MQTT::addSensor(const String& name, const char* unit, float deadband, uint32_t sample_interval_ms)
+{
+    const int id = addComponent("sensor", name);
+    if (id < 0)
+        return id;
+    _components[id].unit                = unit;
+    _components[id].deadband            = deadband;
+    _components[id].publish_interval_ms = sample_interval_ms;
+    return id;
+}
+
+int MQTT::addNumber(const String& name, float min, float max, float step)
+{
+    const int id = addComponent("number", name);
+    if (id < 0)
+        return id;
+    _components[id].min  = min;
+    _components[id].max  = max;
+    _components[id].step = step;
+    return id;
+}
+
+void MQTT::addRoute(std::vector<Route>& routes, const String& key, uint16_t component)
+{
+    const Route route{topicHash(key.c_str()), component};
+    const auto  at = std::upper_bound(routes.begin(), routes.end(), route, [](const Route& a, const Route& b) {
+        return a.hash < b.hash;
+    });
+    routes.insert(at, route);
+}
+
+// -1 if not found, equal hashes are told apart by the full string
+int MQTT::findComponent(const std::vector<Route>& routes, const char* key, const String Component::*field) const
+{
+    const uint32_t hash = topicHash(key);
+    auto           it   = std::lower_bound(routes.begin(), routes.end(), hash, [](const Route& route, uint32_t h) {
+        return route.hash < h;
+    });
+    for (; it != routes.end() && it->hash == hash; ++it)
+        if (strcmp((_components[it->component].*field).c_str(), key) == 0)
+            return it->component;
+    return -1;
 }
 
 void MQTT::setup()
@@ -25,7 +143,13 @@ void MQTT::setup()
     mac.replace(":", "");
     _device_id = _device_name + String("_") + mac;
 
-    reconnect();
+    // bounds the blocking part of PubSubClient::connect() once the port is known to be open
+    _client.setSocketTimeout(SOCKET_TIMEOUT_S);
+
+    _state                 = ConnectionState::WAITING;
+    _backoff_ms            = _backoff_min_ms;
+    _disconnected_since_us = util::now_us();
+    _retry.set(0); // first attempt in the next loop()
 }
 
 void MQTT::loop()
@@ -33,8 +157,8 @@ void MQTT::loop()
     if (!_isActive)
         return;
 
-    if (!_client.connected())
-        reconnect();
+    if (!updateConnection())
+        return;
 
     _client.loop();
 
@@ -42,7 +166,7 @@ void MQTT::loop()
     {
         for (const auto& component : _components)
         {
-            if (component.platform == "light")
+            if (PLATFORMS[size_t(component.type)].command)
             {
                 printf("Subscribing to %s\n", getCommandTopicFromComponents(component).c_str());
                 _client.subscribe(getCommandTopicFromComponents(component).c_str());
@@ -51,65 +175,129 @@ void MQTT::loop()
         _subscribed = true;
         printf("Subscribed to all topics\n");
     }
+
+    flushPending();
+    flushDiscovery();
 }
 
-void MQTT::publishComponent(String component_name, const DynamicJsonDocument& stateDoc)
+void MQTT::setPublishInterval(uint32_t min_interval_ms)
 {
-    for (const auto& component : _components)
-        if (component.name == component_name)
-        {
-            publishState(getStateTopicFromComponents(component), stateDoc);
-            return;
-        }
-    printf("Error: Component not found: %s\n", component_name.c_str());
+    _publish_interval_ms = min_interval_ms;
+    for (auto& component : _components)
+        component.publish_interval_ms = min_interval_ms;
+}
+
+void MQTT::setPublishInterval(const String& component_name, uint32_t min_interval_ms)
+{
+    const int index = findComponent(_name_routes, component_name.c_str(), &Component::name);
+    if (index < 0)
+    {
+        printf("Error: Component not found: %s\n", component_name.c_str());
+        return;
+    }
+    _components[index].publish_interval_ms = min_interval_ms;
 }
 
-void MQTT::publishLight(String component_name, float percent)
+void MQTT::publishComponent(const String& component_name, const JsonDocument& stateDoc)
+{
+    const int index = findComponent(_name_routes, component_name.c_str(), &Component::name);
+    if (index < 0)
+    {
+        printf("Error: Component not found: %s\n", component_name.c_str());
+        return;
+    }
+    publishState(uint16_t(index), stateDoc);
+}
+
+void MQTT::publishLight(const String& component_name, float percent)
 {
     if (!_isActive)
         return;
 
     uint8_t brightness = util::mapConstrainf(percent, 0.0f, 1.0f, 0, 255);
 
-    DynamicJsonDocument stateDoc(200);
+    JsonDocument& stateDoc = _tx_doc;
+    stateDoc.clear();
     stateDoc["state"] = brightness > 0 ? "ON" : "OFF";
     if (brightness > 0)
         stateDoc["brightness"] = brightness;
 
-    printf("publishLight %s: %2.2f | homeassistant=%d | raw=%d\n",
-           component_name.c_str(),
-           percent,
-           int(percent * 100),
-           brightness);
+    if (_verbose)
+        printf("publishLight %s: %2.2f | homeassistant=%d | raw=%d\n",
+               component_name.c_str(),
+               percent,
+               int(percent * 100),
+               brightness);
 
     publishComponent(component_name, stateDoc);
     return;
 }
 
-bool MQTT::isRechableAndActive()
+void MQTT::publishValue(int id, float value)
 {
-    printf("Trying to reach MQTT server...\n");
-    WiFiClient client;
-    for (int i = 0; i < 3; ++i)
+    if (!_isActive)
+        return;
+    if (id < 0 || size_t(id) >= _components.size() ||
+        (_components[id].type != Platform::SENSOR && _components[id].type != Platform::NUMBER))
     {
-        if (client.connect(_server, _port))
-        {
-            _isActive = true;
-            return _isActive;
-        }
-        delay(500);
+        printf("ERROR in MQTT::publishValue: %d is not a sensor/number\n", id);
+        return;
+    }
+
+    Component& component = _components[id];
+    if (fabsf(value - component.last_value) < component.deadband) // false while last_value is NAN
+    {
+        _publish_stats.suppressed++;
+        return;
     }
-    _isActive = false;
+    component.last_value = value;
+
+    char payload[16];
+    snprintf(payload, sizeof(payload), "%g", value);
+    queueState(uint16_t(id)) = payload;
+}
+
+void MQTT::publishOnOff(int id, bool on)
+{
     if (!_isActive)
-        printf("MQTT server not reachable, skipping MQTT setup.");
+        return;
+    if (id < 0 || size_t(id) >= _components.size() ||
+        (_components[id].type != Platform::SWITCH && _components[id].type != Platform::BINARY_SENSOR))
+    {
+        printf("ERROR in MQTT::publishOnOff: %d is not a switch/binary_sensor\n", id);
+        return;
+    }
+    queueState(uint16_t(id)) = on ? "ON" : "OFF";
+}
+
+// The broker is probed from loop() now, so this only enables MQTT. A broker
+// that is down at boot is picked up as soon as it is reachable.
+bool MQTT::isRechableAndActive()
+{
+    _isActive = true;
     return _isActive;
 }
 
+void MQTT::setReconnectBackoff(uint32_t min_ms, uint32_t max_ms)
+{
+    _backoff_min_ms = std::max(min_ms, uint32_t(1));
+    _backoff_max_ms = std::max(max_ms, _backoff_min_ms);
+    _backoff_ms     = _backoff_min_ms;
+}
+
+MQTT::ConnectionStats MQTT::connectionStats() const
+{
+    ConnectionStats stats = _stats;
+    if (_state != ConnectionState::CONNECTED)
+        stats.disconnected_us += util::now_us() - _disconnected_since_us;
+    return stats;
+}
+
 void MQTT::setLightChangeCallback(LightChangeCallback callback) { _lightChangeCallback = callback; }
 
 void MQTT::setLightToggleCallback(LightToggleCallback callback) { _lightToggleCallback = callback; }
 
-void MQTT::publishDiscoveryMessage(Component& component)
+void MQTT::publishDiscoveryMessage(const Component& component)
 {
     if (!_isActive)
         return;
@@ -120,9 +308,8 @@ void MQTT::publishDiscoveryMessage(Component& component)
     String discoveryTopic =
         _discovery_prefix + "/" + component.platform + "/" + object_id + "/config";
 
-    String state_topic = getStateTopicFromComponents(component);
-
-    DynamicJsonDocument doc(1024);
+    JsonDocument& doc = _tx_doc;
+    doc.clear();
 
     JsonObject device = doc.createNestedObject("device");
     device["name"]    = _device_name;
@@ -135,77 +322,197 @@ void MQTT::publishDiscoveryMessage(Component& component)
     device["hw"]  = "0.1";
 
     // 3) Top-level entity info
-    doc["name"]      = component.name; // friendly object_id
-    doc["unique_id"] = object_id;      // MUST match the topic object_id
+    doc["name"]        = component.name; // friendly object_id
+    doc["unique_id"]   = object_id;      // MUST match the topic object_id
+    doc["state_topic"] = getStateTopicFromComponents(component);
 
     // 4) Platform-specific configuration
-    if (component.platform == "light")
+    const DiscoveryHandler discovery = PLATFORMS[size_t(component.type)].discovery;
+    if (discovery)
+        (this->*discovery)(component, doc);
+
+    // 5) Publish discovery message, serialized straight into the connection
+    const size_t length = measureJson(doc);
+    printf("Publishing discovery message to %s (%u bytes)\n", discoveryTopic.c_str(), unsigned(length));
+    if (!_client.beginPublish(discoveryTopic.c_str(), length, true))
+        return;
     {
-        doc["platform"] = "mqtt";
-        doc["schema"]   = "json";
-
-        doc["state_topic"]   = state_topic;
-        doc["command_topic"] = getCommandTopicFromComponents(component);
-
-        doc["brightness"] = true;
-        doc["rgb"]        = false;
-        doc["white_value"] = false;
-        doc["color_temp"]  = false;
-        doc["effect"]      = false;
-        doc["flash"]       = false;
-        doc["transition"]  = false;
-
-        doc["optimistic"] = false;
-        doc["retain"]     = false;
+        ChunkedPrint out(_client);
+        serializeJson(doc, out);
     }
+    _client.endPublish();
+}
 
-    // 5) Publish discovery message
-    String jsonString;
-    serializeJson(doc, jsonString);
-    printf("Publishing discovery message to %s: %s\n", discoveryTopic.c_str(), jsonString.c_str());
-    _client.publish(discoveryTopic.c_str(), jsonString.c_str(), true);
+// a few per loop() call, they are big
+void MQTT::flushDiscovery()
+{
+    for (uint16_t sent = 0; _discovery_next < _components.size() && sent < _publish_batch; sent++)
+    {
+        if (!_client.connected())
+            return;
+        publishDiscoveryMessage(_components[_discovery_next++]);
+    }
 }
 
-void MQTT::reconnect()
+void MQTT::lightDiscovery(const Component& component, JsonDocument& doc)
 {
-    if (_isActive)
+    doc["platform"] = "mqtt";
+    doc["schema"]   = "json";
+
+    doc["command_topic"] = getCommandTopicFromComponents(component);
+
+    doc["brightness"]  = true;
+    doc["rgb"]         = false;
+    doc["white_value"] = false;
+    doc["color_temp"]  = false;
+    doc["effect"]      = false;
+    doc["flash"]       = false;
+    doc["transition"]  = false;
+
+    doc["optimistic"] = false;
+    doc["retain"]     = false;
+}
+
+void MQTT::sensorDiscovery(const Component& component, JsonDocument& doc)
+{
+    doc["state_class"] = "measurement";
+    if (component.unit.length())
+        doc["unit_of_measurement"] = component.unit;
+}
+
+void MQTT::switchDiscovery(const Component& component, JsonDocument& doc)
+{
+    doc["command_topic"] = getCommandTopicFromComponents(component);
+    doc["optimistic"]    = false;
+}
+
+void MQTT::numberDiscovery(const Component& component, JsonDocument& doc)
+{
+    doc["command_topic"] = getCommandTopicFromComponents(component);
+    doc["min"]           = component.min;
+    doc["max"]           = component.max;
+    doc["step"]          = component.step;
+    if (component.unit.length())
+        doc["unit_of_measurement"] = component.unit;
+}
+
+// One step of the connection state machine. DNS and the probe never wait,
+// connectClient() does: PubSubClient::connect() opens its own TCP connection
+// and waits for CONNACK, each bounded by SOCKET_TIMEOUT_S, only ever started
+// with the port just probed open.
+bool MQTT::updateConnection()
+{
+    switch (_state)
     {
-        printf("Attempting MQTT connection...\n");
-        // Create a random client ID
-        String clientId = "ESP8266Client-";
-        clientId += String(random(0xffff), HEX);
-        // Attempt to connect
-        if (_client.connect(clientId.c_str()))
+    case ConnectionState::CONNECTED:
+        if (_client.connected())
+            return true;
+        printf("MQTT connection lost, rc=%d\n", _client.state());
+        _stats.disconnects++;
+        _disconnected_since_us = util::now_us();
+        _backoff_ms            = _backoff_min_ms;
+        _state                 = ConnectionState::WAITING;
+        _retry.set(0);
+        return false;
+
+    case ConnectionState::WAITING:
+        if (!_retry.expired())
+            return false;
+        if (WiFi.status() != WL_CONNECTED)
         {
-            printf("connected\n");
-            // Once connected, publish an announcement...
-            _client.publish("outTopic", "hello world");
-            // ... and resubscribe
-            _client.subscribe("inTopic");
+            _retry.set_ms(_backoff_min_ms);
+            return false;
         }
-        else
+        _stats.attempts++;
+        _probe.start(_server, _port);
+        _probe_timeout.set_ms(PROBE_TIMEOUT_MS);
+        _state = ConnectionState::PROBING;
+        return false;
+
+    case ConnectionState::PROBING:
+        switch (_probe.poll())
         {
-            printf("failed, rc=");
-            printf("%d", _client.state());
-            printf(" try again in 5 seconds\n");
-            // Wait 5 seconds before retrying
-            delay(5000);
+        case util::TcpProbe::OPEN:
+            connectClient();
+            return connected();
+        case util::TcpProbe::PENDING:
+            if (_probe_timeout.expired())
+                connectionFailed(MQTT_CONNECTION_TIMEOUT);
+            return false;
+        default:
+            connectionFailed(MQTT_CONNECT_FAILED);
+            return false;
         }
     }
+    return false;
 }
 
-void MQTT::handleCallback(char* topic, byte* payload, unsigned int length)
+void MQTT::connectClient()
 {
-    printf("Message arrived [");
-    printf("%s", topic);
-    printf("] ");
-    for (int i = 0; i < length; i++)
+    _probe.stop();
+
+    // the resolved address, so PubSubClient does not look up the name again (blocking)
+    IPAddress ip;
+    if (_probe.address(ip))
+        _client.setServer(ip, _port);
+
+    printf("Attempting MQTT connection...\n");
+    // Create a random client ID
+    String clientId = "ESP8266Client-";
+    clientId += String(random(0xffff), HEX);
+    if (!_client.connect(clientId.c_str()))
     {
-        printf("%c", (char)payload[i]);
+        connectionFailed(_client.state());
+        return;
     }
-    printf("\n");
 
-    DynamicJsonDocument  doc(200);
+    printf("connected\n");
+    _stats.connects++;
+    _stats.disconnected_us += util::now_us() - _disconnected_since_us;
+    _backoff_ms = _backoff_min_ms;
+    _subscribed = false; // new session, subscribe again in loop()
+    _state      = ConnectionState::CONNECTED;
+
+    // Once connected, publish an announcement...
+    _client.publish("outTopic", "hello world");
+    // ... and resubscribe
+    _client.subscribe("inTopic");
+}
+
+void MQTT::connectionFailed(int error)
+{
+    _probe.stop();
+    _probe.forgetAddress(); // the broker may have moved, the next lookup is async as well
+    _client.disconnect();   // drops a half open connection of the fallback probe
+
+    // 75..125% of the backoff
+    const uint32_t delay_ms = _backoff_ms - _backoff_ms / 4 + uint32_t(random(_backoff_ms / 2 + 1));
+    printf("MQTT connection failed, rc=%d, try again in %u ms\n", error, unsigned(delay_ms));
+
+    _stats.failures++;
+    _stats.last_error = error;
+    _retry.set_ms(delay_ms);
+    _backoff_ms = std::min(_backoff_ms * 2, _backoff_max_ms);
+    _state      = ConnectionState::WAITING;
+}
+
+void MQTT::handleCallback(char* topic, byte* payload, unsigned int length)
+{
+    if (_verbose)
+        printf("Message arrived [%s] %.*s\n", topic, int(length), (const char*)payload);
+
+    // match against the topic table, no Strings are built per message
+    const int index = findComponent(_command_routes, topic, &Component::command_topic);
+    if (index < 0)
+        return;
+
+    const Component& component = _components[index];
+    (this->*PLATFORMS[size_t(component.type)].command)(component, payload, length);
+}
+
+void MQTT::lightCommand(const Component& component, const byte* payload, unsigned int length)
+{
+    JsonDocument&        doc   = _rx_doc;
     DeserializationError error = deserializeJson(doc, payload, length);
 
     if (error)
@@ -216,57 +523,104 @@ void MQTT::handleCallback(char* topic, byte* payload, unsigned int length)
         return;
     }
 
-    // Extract platform and object_id from topic
-    String topic_str = String(topic);
-    int    lastSlash = topic_str.lastIndexOf('/');
-    if (lastSlash == -1)
-        return;
+    processLightCommand(component.name, doc);
+}
 
-    String command = topic_str.substring(lastSlash + 1);
-    String topic_without_command = topic_str.substring(0, lastSlash);
+// payload "ON" / "OFF" (Home Assistant defaults)
+void MQTT::switchCommand(const Component& component, const byte* payload, unsigned int length)
+{
+    const bool on = length == 2 && memcmp(payload, "ON", 2) == 0;
+    if (!on && !(length == 3 && memcmp(payload, "OFF", 3) == 0))
+    {
+        printf("ERROR in MQTT::switchCommand: %s: invalid payload %.*s\n", component.name.c_str(), int(length), (const char*)payload);
+        return;
+    }
+    if (_switchCallback)
+        _switchCallback(component.name, on);
+}
 
-    lastSlash = topic_without_command.lastIndexOf('/');
-    if (lastSlash == -1)
+void MQTT::numberCommand(const Component& component, const byte* payload, unsigned int length)
+{
+    char text[24];
+    if (length == 0 || length >= sizeof(text))
         return;
+    memcpy(text, payload, length);
+    text[length] = '\0';
 
-    String object_id = topic_without_command.substring(lastSlash + 1);
-    String platform  = topic_without_command.substring(0, lastSlash);
+    char*       end   = nullptr;
+    const float value = strtof(text, &end);
+    if (end == text)
+    {
+        printf("ERROR in MQTT::numberCommand: %s: invalid payload %s\n", component.name.c_str(), text);
+        return;
+    }
+    if (_numberCallback)
+        _numberCallback(component.name, constrain(value, component.min, component.max));
+}
 
-    lastSlash = platform.lastIndexOf('/');
-    if (lastSlash == -1)
+void MQTT::publishState(uint16_t index, const JsonDocument& stateDoc)
+{
+    if (!_isActive)
         return;
 
-    platform = platform.substring(lastSlash + 1);
+    // a state is a few bytes, kept serialized so that it survives until the flush
+    serializeJson(stateDoc, queueState(index));
+}
 
-    // Find matching component
-    for (const auto& component : _components)
-        if (component.platform == platform && component.name == object_id)
-        {
-            if (command == "set")
-            {
-                processLightCommand(component.name, doc);
-            }
-            break;
-        }
+String& MQTT::queueState(uint16_t index)
+{
+    Component& component = _components[index];
+    _publish_stats.queued++;
+    if (component.pending)
+        _publish_stats.coalesced++;
+    else
+    {
+        component.pending = true;
+        _pending.push_back(index);
+    }
+    component.pending_payload = ""; // keeps the capacity, no allocation once it was used
+    return component.pending_payload;
 }
 
-void MQTT::publishState(const String& topic, const DynamicJsonDocument& stateDoc)
+// sends due states, at most _publish_batch per call
+void MQTT::flushPending()
 {
-    if (!_isActive)
-        return;
+    uint16_t sent = 0;
+    for (size_t i = 0; i < _pending.size() && sent < _publish_batch && _client.connected();)
+    {
+        Component& component = _components[_pending[i]];
+        if (!component.next_publish.expired())
+        {
+            i++;
+            continue;
+        }
+
+        if (_verbose)
+            printf("Publishing state to %s: %s\n", component.state_topic.c_str(), component.pending_payload.c_str());
+        // beginPublish() writes the payload straight to the client instead of copying it into
+        // the PubSubClient buffer first
+        const String& payload = component.pending_payload;
+        if (_client.beginPublish(component.state_topic.c_str(), payload.length(), false) &&
+            _client.write(reinterpret_cast<const uint8_t*>(payload.c_str()), payload.length()) == payload.length() &&
+            _client.endPublish())
+            _publish_stats.published++;
+        else
+            _publish_stats.dropped++;
+        sent++;
 
-    String jsonString;
-    serializeJson(stateDoc, jsonString);
-    printf("Publishing state to %s: %s\n", topic.c_str(), jsonString.c_str());
-    _client.publish(topic.c_str(), jsonString.c_str());
+        component.pending = false;
+        component.next_publish.set_ms(component.publish_interval_ms);
+        _pending[i] = _pending.back(); // order does not matter, every entry is a different component
+        _pending.pop_back();
+    }
 }
 
-void MQTT::processLightCommand(const String& component_name, const DynamicJsonDocument& doc)
+void MQTT::processLightCommand(const String& component_name, const JsonDocument& doc)
 {
     if (doc.containsKey("state"))
     {
-        String state = doc["state"];
-        if (state == "ON")
+        const char* state = doc["state"];
+        if (state && strcmp(state, "ON") == 0)
         {
             float brightness = 1.0f;
             if (doc.containsKey("brightness"))
@@ -275,7 +629,7 @@ void MQTT::processLightCommand(const String& component_name, const DynamicJsonDo
             }
             lightChange(component_name, brightness);
         }
-        else if (state == "OFF")
+        else if (state && strcmp(state, "OFF") == 0)
         {
             lightChange(component_name, 0.0f);
         }
@@ -289,7 +643,8 @@ void MQTT::processLightCommand(const String& component_name, const DynamicJsonDo
 
 void MQTT::lightChange(const String& component_name, float percent)
 {
-    printf("lightChange %s: %2.2f\n", component_name.c_str(), percent);
+    if (_verbose)
+        printf("lightChange %s: %2.2f\n", component_name.c_str(), percent);
     if (_lightChangeCallback)
         _lightChangeCallback(component_name, percent);
 }
@@ -8,6 +8,29 @@
  * an MQTT server. It includes functionality to send and receive messages, handle light component
  * commands, and publish discovery messages.
  *
+ * The connection is kept up from loop(): a lost or unreachable broker is
+ * retried with exponential backoff (+ jitter, so a fleet does not reconnect
+ * in lockstep). On ESP32 the name lookup and the TCP port probe do not wait
+ * (see tcp_probe.h), so a broker that is down or unreachable costs loop()
+ * nothing. Once the port is open PubSubClient::connect() still blocks: it
+ * opens its own TCP connection (to the probed address, no DNS) and waits
+ * for CONNACK, each up to SOCKET_TIMEOUT_S (2 s). A broker that accepts the
+ * connection but does not answer stalls loop() for that long per attempt.
+ * ESP8266/host: the probe is a blocking Client::connect().
+ * connectionStats() counts attempts and the time spent disconnected.
+ *
+ * States are not sent right away: publishLight()/publishComponent() keep
+ * only the latest state per component, loop() sends at most one per
+ * component every setPublishInterval() ms and a few per call. A fade that
+ * updates a light every 2 ms ends up as 10 publishes/s, the final value is
+ * always sent.
+ *
+ * Components: light, sensor, binary_sensor, switch and number. The platform
+ * is resolved once in addComponent(), discovery, subscriptions and incoming
+ * commands then go through the PLATFORMS handler table. Sensors have a
+ * deadband and a sampling interval, publishValue() can be called from the
+ * control loop at any rate.
+ *
  * Usage:
  *
  * void setup() {
@@ -25,21 +48,24 @@
  * }
  */
 
-// CURRENTLY ONLY TESTED with "light" components
-
-#if defined(ARDUINO_ARCH_ESP32)
-#include <WiFi.h>
-#endif
+// CURRENTLY ONLY TESTED with "light" components (sensor/switch/number only on the host build)
 
 #if defined(ARDUINO_ARCH_ESP8266)
 #include <ESP8266WiFi.h>
+#else
+#include <WiFi.h> // ESP32 and the host shim
 #endif
 
 #include <PubSubClient.h>
 #include <ArduinoJson.h>
+#include <cmath>
+#include <cstdint>
 #include <functional>
 #include <vector>
 
+#include "../arduino_time.h"
+#include "tcp_probe.h"
+
 #define USE_NODE_ID 0
 
 // should always be used like:
@@ -62,35 +88,133 @@ class MQTT
 public:
     using LightChangeCallback = std::function<void(const String&, float)>;
     using LightToggleCallback = std::function<void(const String&, bool)>;
+    using SwitchCallback      = std::function<void(const String&, bool)>;
+    using NumberCallback      = std::function<void(const String&, float)>;
+
+    enum class Platform : uint8_t
+    {
+        LIGHT,         // JSON schema, brightness
+        SENSOR,        // value out
+        BINARY_SENSOR, // ON/OFF out
+        SWITCH,        // ON/OFF in and out
+        NUMBER,        // value in and out
+        COUNT,
+    };
 
     MQTT(const char* server, int port, const String& device_name);
     MQTT(const char* server, int port, Client& client, const String& device_name);
 
+    enum class ConnectionState : uint8_t
+    {
+        WAITING,   // backoff before the next attempt
+        PROBING,   // TCP probe running
+        CONNECTED,
+    };
+
+    struct ConnectionStats
+    {
+        uint32_t attempts        = 0;
+        uint32_t connects        = 0;
+        uint32_t failures        = 0;
+        uint32_t disconnects     = 0; // lost after being connected
+        time_us  disconnected_us = 0; // total, including the current outage
+        int      last_error      = 0; // PubSubClient state() of the last failure
+    };
+
     void setup();
-    bool isRechableAndActive(); // call this once in the beginning
+    bool isRechableAndActive(); // call this once in the beginning, does not wait for the broker
+
+    void loop(); // blocks only in PubSubClient::connect() once the port is open, up to SOCKET_TIMEOUT_S
+
+    // delay before the next attempt, doubled after every failure (with +-25% jitter)
+    void setReconnectBackoff(uint32_t min_ms, uint32_t max_ms);
+
+    bool            connected() const { return _state == ConnectionState::CONNECTED; }
+    ConnectionState connectionState() const { return _state; }
+    ConnectionStats connectionStats() const;
+
+    void publishComponent(const String& component_name, const JsonDocument& stateDoc);
+    void publishLight(const String& component_name, float percent);
+
+    // per message/publish printf's, turn off for many components or high rates
+    void setVerbose(bool verbose) { _verbose = verbose; }
+
+    struct PublishStats
+    {
+        uint32_t queued     = 0; // publishLight()/publishComponent()/... calls
+        uint32_t coalesced  = 0; // replaced by a newer state before they were sent
+        uint32_t suppressed = 0; // publishValue() within the deadband
+        uint32_t published  = 0;
+        uint32_t dropped    = 0; // rejected by PubSubClient (too big, connection lost)
+    };
 
-    void loop();
-    void publishComponent(String component_name, const DynamicJsonDocument& stateDoc);
-    void publishLight(String component_name, float percent);
+    // min time between two publishes of the same component (default 100 ms), 0 = no limit
+    void setPublishInterval(uint32_t min_interval_ms);
+    void setPublishInterval(const String& component_name, uint32_t min_interval_ms);
+    // max publishes per loop() call
+    void setPublishBatch(uint16_t max_per_loop) { _publish_batch = max_per_loop; }
+
+    const PublishStats& publishStats() const { return _publish_stats; }
+    size_t              pendingPublishes() const { return _pending.size(); }
 
     bool _isActive = false;
 
     void setLightChangeCallback(LightChangeCallback callback);
 
     void setLightToggleCallback(LightToggleCallback callback);
+    void setSwitchCallback(SwitchCallback callback) { _switchCallback = callback; }
+    void setNumberCallback(NumberCallback callback) { _numberCallback = callback; }
 
     struct Component
     {
-        String platform;
-        String name; // != object_id as the object_id contains device_name to be unique in
-                     // homeassistant
+        String   platform;
+        Platform type;
+        String   name; // != object_id as the object_id contains device_name to be unique in
+                       // homeassistant
+
+        // sensor / number
+        String unit;
+        float  min        = 0;
+        float  max        = 100;
+        float  step       = 1;
+        float  deadband   = 0;
+        float  last_value = NAN; // last queued value
+
+        // built once in addComponent()
+        String state_topic;
+        String command_topic;
+
+        // outbound queue: latest state only
+        String         pending_payload;
+        bool           pending             = false;
+        uint32_t       publish_interval_ms = 0;
+        util::Deadline next_publish;
     };
 
     // Usage:
     // addLight("some_light");
-    // addComponent("sensor", "position"); // theoretically , but not implemented
-    void addLight(const String& name) { addComponent("light", name); }
-    void addComponent(const String& platform, const String& name);
+    // int position = addSensor("position", "mm", 0.5f, 200); // 0.5 mm deadband, at most every 200 ms
+    // publishValue(position, pid._input);                      // as often as you like
+    // addSwitch("enable"); addNumber("target", 0, 100); addBinarySensor("endstop");
+    //
+    // @return component id for publishValue()/publishOnOff(), -1 on error
+    int addLight(const String& name) { return addComponent("light", name); }
+    int addSensor(const String& name, const char* unit = "", float deadband = 0, uint32_t sample_interval_ms = 1000);
+    int addBinarySensor(const String& name) { return addComponent("binary_sensor", name); }
+    int addSwitch(const String& name) { return addComponent("switch", name); }
+    int addNumber(const String& name, float min, float max, float step = 1);
+    int addComponent(const String& platform, const String& name);
+
+    int componentId(const String& name) const { return findComponent(_name_routes, name.c_str(), &Component::name); }
+
+    // sensor, number: only queued if it moved by at least the deadband since the last one
+    void publishValue(int component, float value);
+    // switch, binary_sensor
+    void publishOnOff(int component, bool on);
+
+    // (re)sends the retained Home Assistant discovery config of all components,
+    // a few per loop() call
+    void publishDiscovery() { _discovery_next = 0; }
 
     std::vector<Component> _components;
 
@@ -100,23 +224,82 @@ private:
     int          _port;
 
     bool _subscribed = false;
+    bool _verbose    = true;
+
+    std::vector<uint16_t> _pending; // components with pending_payload
+    PublishStats          _publish_stats;
+    uint32_t              _publish_interval_ms = 100;
+    uint16_t              _publish_batch       = 4;
+    size_t                _discovery_next      = SIZE_MAX; // next component to send the discovery of
+
+    // reused for every message instead of a DynamicJsonDocument per call
+    StaticJsonDocument<1024> _tx_doc; // states and discovery, built and sent right away
+    StaticJsonDocument<256>  _rx_doc; // incoming commands
+
+    // per platform handlers, indexed by Platform, nullptr = not supported
+    using CommandHandler   = void (MQTT::*)(const Component&, const byte* payload, unsigned int length);
+    using DiscoveryHandler = void (MQTT::*)(const Component&, JsonDocument& doc);
+    struct PlatformInfo
+    {
+        const char*      name;
+        CommandHandler   command;
+        DiscoveryHandler discovery;
+    };
+    static const PlatformInfo PLATFORMS[size_t(Platform::COUNT)];
 
-    void reconnect();
-    void publishDiscoveryMessage(Component& component);
+    // topic table: sorted by hash, a lookup is a binary search + one strcmp
+    struct Route
+    {
+        uint32_t hash;
+        uint16_t component;
+    };
+    std::vector<Route> _command_routes; // by command_topic
+    std::vector<Route> _name_routes;    // by name
+
+    static uint32_t topicHash(const char* str) // FNV-1a
+    {
+        uint32_t hash = 2166136261u;
+        while (*str)
+            hash = (hash ^ uint8_t(*str++)) * 16777619u;
+        return hash;
+    }
+
+    static void addRoute(std::vector<Route>& routes, const String& key, uint16_t component);
+    int         findComponent(const std::vector<Route>& routes, const char* key, const String Component::*field) const;
+
+    static constexpr uint32_t PROBE_TIMEOUT_MS = 3000;
+    static constexpr uint16_t SOCKET_TIMEOUT_S = 2; // blocking TCP connect + CONNACK wait once the port is open
+
+    util::TcpProbe  _probe;
+    ConnectionState _state = ConnectionState::WAITING;
+    ConnectionStats _stats;
+    util::Deadline  _retry;
+    util::Deadline  _probe_timeout;
+    time_us         _disconnected_since_us = 0;
+    uint32_t        _backoff_min_ms        = 500;
+    uint32_t        _backoff_max_ms        = 60000;
+    uint32_t        _backoff_ms            = 500;
+
+    bool updateConnection(); // true while connected
+    void connectClient();
+    void connectionFailed(int error);
+    void publishDiscoveryMessage(const Component& component);
     void handleCallback(char* topic, byte* payload, unsigned int length);
 
     LightChangeCallback _lightChangeCallback;
     LightToggleCallback _lightToggleCallback;
+    SwitchCallback      _switchCallback;
+    NumberCallback      _numberCallback;
 
     const String _discovery_prefix = "homeassistant";
     String      _device_name;
 
     String _device_id;
 
-    String getStateTopicFromComponents(Component cmp) { return getBaseTopic(cmp) + "/state"; }
-    String getCommandTopicFromComponents(Component cmp) { return getBaseTopic(cmp) + "/set"; }
+    const String& getStateTopicFromComponents(const Component& cmp) const { return cmp.state_topic; }
+    const String& getCommandTopicFromComponents(const Component& cmp) const { return cmp.command_topic; }
 
-    String getBaseTopic(Component cmp)
+    String getBaseTopic(const Component& cmp) const
     {
 #if USE_NODE_ID
         return _device_name + "/" + cmp.platform + "/" + _device_name + "/" + cmp.name;
@@ -125,9 +308,21 @@ private:
 #endif
     }
 
-    void publishState(const String& topic, const DynamicJsonDocument& stateDoc);
+    void    publishState(uint16_t component, const JsonDocument& stateDoc); // queues
+    String& queueState(uint16_t component); // marks it pending, returns the (cleared) payload
+    void    flushPending();
+    void    flushDiscovery();
+
+    void lightCommand(const Component& component, const byte* payload, unsigned int length);
+    void switchCommand(const Component& component, const byte* payload, unsigned int length);
+    void numberCommand(const Component& component, const byte* payload, unsigned int length);
+
+    void lightDiscovery(const Component& component, JsonDocument& doc);
+    void sensorDiscovery(const Component& component, JsonDocument& doc);
+    void switchDiscovery(const Component& component, JsonDocument& doc);
+    void numberDiscovery(const Component& component, JsonDocument& doc);
 
-    void processLightCommand(const String& component_name, const DynamicJsonDocument& doc);
+    void processLightCommand(const String& component_name, const JsonDocument& doc);
 
     void lightChange(const String& component_name, float percent);
     void lightToggle(const String& component_name, bool state);
@@ -0,0 +1,265 @@
+#pragma once
+
+/**
+ * @file tcp_probe.h
+ * @brief Checks if a TCP port is reachable without blocking the loop
+ *
+ * ESP32: the host name is looked up with lwIP's asynchronous DNS (the
+ * answer arrives in a callback, poll() picks it up), then a non-blocking
+ * socket only sends the SYN and poll() looks at it with a zero timeout, so
+ * neither start() nor poll() waits for the network. The address is cached
+ * until forgetAddress(), address() hands it to PubSubClient::setServer() so
+ * that one does not resolve the name again (WiFi.hostByName() blocks).
+ *
+ * Elsewhere (ESP8266, host) there is no non-blocking connect, start() calls
+ * Client::connect() on the client that is used afterwards. On success the
+ * connection stays open and PubSubClient::connect() reuses it.
+ *
+ * Usage:
+ *
+ * util::TcpProbe probe(client);
+ * probe.start("broker.local", 1883);
+ *
+ * void loop() {
+ *   if (probe.poll() == util::TcpProbe::OPEN) { ... }
+ * }
+ */
+
+#include <Arduino.h>
+#include <Client.h>
+
+#if defined(ARDUINO_ARCH_ESP32) && !defined(ARDUINO_HOST)
+#include <WiFi.h>
+#include <atomic>
+#include <esp_netif.h>
+#include <lwip/dns.h>
+#include <lwip/sockets.h>
+#define UTIL_TCP_PROBE_ASYNC 1
+#else
+#define UTIL_TCP_PROBE_ASYNC 0
+#endif
+
+namespace util {
+
+class TcpProbe
+{
+public:
+    enum Result : uint8_t
+    {
+        IDLE,
+        PENDING,
+        OPEN,
+        FAILED,
+    };
+
+    explicit TcpProbe(Client& client) : _client(client) {}
+    ~TcpProbe()
+    {
+        stop();
+#if UTIL_TCP_PROBE_ASYNC
+        // a lookup still in flight is freed by its callback
+        if (_lookup->state == Lookup::PENDING)
+            _lookup->orphaned = true;
+        else
+            delete _lookup;
+#endif
+    }
+
+    TcpProbe(const TcpProbe&)            = delete;
+    TcpProbe& operator=(const TcpProbe&) = delete;
+
+    // starts a new probe, a running one is cancelled
+    Result start(const char* host, uint16_t port)
+    {
+        stop();
+#if UTIL_TCP_PROBE_ASYNC
+        _port = port;
+        if (!_resolved && !_ip.fromString(host))
+        {
+            // a lookup still running from the last attempt is not started again
+            if (_lookup->state != Lookup::PENDING && !startLookup(host))
+                return _result = FAILED;
+            return _result = PENDING;
+        }
+        _resolved = true;
+        return _result = openSocket();
+#else
+        return _result = _client.connect(host, port) ? OPEN : FAILED;
+#endif
+    }
+
+    // never waits
+    Result poll()
+    {
+#if UTIL_TCP_PROBE_ASYNC
+        if (_result != PENDING)
+            return _result;
+
+        if (!_resolved)
+        {
+            switch (_lookup->state)
+            {
+            case Lookup::PENDING:
+                return _result;
+            case Lookup::FOUND:
+                _ip       = IPAddress(_lookup->ip);
+                _resolved = true;
+                _result   = openSocket();
+                if (_result != PENDING)
+                    return _result;
+                break;
+            default:
+                return _result = FAILED;
+            }
+        }
+
+        fd_set writable;
+        FD_ZERO(&writable);
+        FD_SET(_fd, &writable);
+        timeval zero = {0, 0};
+        if (lwip_select(_fd + 1, nullptr, &writable, nullptr, &zero) <= 0)
+            return _result; // still connecting
+
+        int       error = 0;
+        socklen_t size  = sizeof(error);
+        lwip_getsockopt(_fd, SOL_SOCKET, SO_ERROR, &error, &size);
+        _result = error == 0 ? OPEN : FAILED;
+        close();
+#endif
+        return _result;
+    }
+
+    // cancels a pending probe (the fallback keeps an open client connected)
+    void stop()
+    {
+#if UTIL_TCP_PROBE_ASYNC
+        close();
+#endif
+        _result = IDLE;
+    }
+
+    // forces a new name lookup on the next start()
+    void forgetAddress()
+    {
+#if UTIL_TCP_PROBE_ASYNC
+        _resolved = false;
+#endif
+    }
+
+    // false until the name is resolved (and always without the async path)
+    bool address(IPAddress& ip) const
+    {
+#if UTIL_TCP_PROBE_ASYNC
+        if (_resolved)
+            ip = _ip;
+        return _resolved;
+#else
+        (void)ip;
+        return false;
+#endif
+    }
+
+    Result result() const { return _result; }
+
+private:
+    Client& _client;
+    Result  _result = IDLE;
+
+#if UTIL_TCP_PROBE_ASYNC
+    // shared with the DNS callback (lwIP thread), heap allocated so that a
+    // callback arriving after the probe is gone has something to free
+    struct Lookup
+    {
+        enum State : uint8_t
+        {
+            IDLE,
+            PENDING,
+            FOUND,
+            FAILED,
+        };
+
+        std::atomic<uint8_t> state{IDLE};
+        std::atomic<bool>    orphaned{false};
+        const char*          host = nullptr;
+        uint32_t             ip   = 0;
+    };
+
+    int       _fd       = -1;
+    uint16_t  _port     = 0;
+    bool      _resolved = false;
+    IPAddress _ip;
+
+    Lookup*   _lookup   = new Lookup;
+
+    // queues the query in the lwIP thread, does not wait for the answer
+    bool startLookup(const char* host)
+    {
+        _lookup->host  = host;
+        _lookup->state = Lookup::PENDING;
+        esp_netif_tcpip_exec(queryInLwip, _lookup); // runs and returns right away, the answer comes in found()
+        return _lookup->state != Lookup::FAILED;
+    }
+
+    static esp_err_t queryInLwip(void* arg)
+    {
+        Lookup&   lookup = *static_cast<Lookup*>(arg);
+        ip_addr_t addr   = {};
+#if LWIP_IPV4 && LWIP_IPV6
+        const err_t err = dns_gethostbyname_addrtype(lookup.host, &addr, found, &lookup, LWIP_DNS_ADDRTYPE_IPV4);
+#else
+        const err_t err = dns_gethostbyname(lookup.host, &addr, found, &lookup);
+#endif
+        if (err == ERR_OK) // cached or a literal, no callback
+            found(lookup.host, &addr, &lookup);
+        else if (err != ERR_INPROGRESS)
+            lookup.state = Lookup::FAILED;
+        return ESP_OK;
+    }
+
+    static void found(const char*, const ip_addr_t* addr, void* arg)
+    {
+        Lookup* lookup = static_cast<Lookup*>(arg);
+        if (lookup->orphaned)
+        {
+            delete lookup;
+            return;
+        }
+        if (addr)
+            lookup->ip = ip4_addr_get_u32(ip_2_ip4(addr));
+        lookup->state = addr ? Lookup::FOUND : Lookup::FAILED; // last access, the probe may free it after this
+    }
+
+    Result openSocket()
+    {
+        _fd = lwip_socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (_fd < 0)
+            return FAILED;
+        lwip_fcntl(_fd, F_SETFL, lwip_fcntl(_fd, F_GETFL, 0) | O_NONBLOCK);
+
+        sockaddr_in addr     = {};
+        addr.sin_family      = AF_INET;
+        addr.sin_port        = htons(_port);
+        addr.sin_addr.s_addr = uint32_t(_ip);
+        if (lwip_connect(_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0)
+        {
+            close();
+            return OPEN;
+        }
+        if (errno != EINPROGRESS)
+        {
+            close();
+            return FAILED;
+        }
+        return PENDING;
+    }
+
+    void close()
+    {
+        if (_fd >= 0)
+            lwip_close(_fd);
+        _fd = -1;
+    }
+#endif
+};
+
+} // namespace util
@@ -10,6 +10,8 @@ Driver::Driver(const PWMConfig& pwm_config)
 
 void Driver::setup() {
     pwm_driver_.setup(pwm_driver_.getConfig());
+    last_duty_ = NO_DUTY;
+    last_level_ = NO_DUTY;
     
     // Set default animation to static
     setAnimation(AnimationMode::STATIC);
@@ -21,27 +23,29 @@ void Driver::setup() {
 void Driver::loop() {
     if (!initialized_) return;
     
-    if (since_loop_ > 2) {
-        since_loop_ = 0;
-        applyBrightness();
-    }
+    if (since_loop_.elapsed_ms() >= time_ms(LOOP_PERIOD_MS))
+        update();
+}
+
+void Driver::update() {
+    if (!initialized_) return;
+
+    applyBrightness(since_loop_.restart());
 }
 
 void Driver::set(float percentage) {
-    since_set_ = 0;
     target_brightness_ = util::clipf(percentage, 0.0f, 1.0f);
     
-    // If we have a static animation, update its brightness
-    if (animation_ && animation_->getConfig().mode == AnimationMode::STATIC) {
-        // Create a new static animation with the new brightness
-        animation_ = std::make_unique<StaticAnimation>(target_brightness_);
+    // If we have a static animation, update its brightness (in place, no allocation)
+    if (auto* static_animation = std::get_if<StaticAnimation>(&animation_)) {
+        static_animation->setBrightness(target_brightness_);
     }
 }
 
 void Driver::setDirectly(float percentage) {
     set(percentage);
     current_brightness_ = target_brightness_;
-    applyBrightness();
+    applyBrightness(0);
 }
 
 void Driver::toggle(bool state) {
@@ -59,62 +63,90 @@ void Driver::setAnimation(AnimationMode mode, const AnimationConfig& config) {
     AnimationConfig new_config = config;
     new_config.mode = mode;
     
-    // Create new animation
-    animation_ = createAnimation(mode);
-    if (animation_) {
-        animation_->setConfig(new_config);
-        animation_->reset();
-    }
+    // Replace the animation in place
+    emplaceAnimation(mode);
+    animation().setConfig(new_config);
+    animation().reset();
+}
+
+void Driver::setTimeline(const Timeline& timeline, const AnimationConfig& config) {
+    setAnimation(AnimationMode::TIMELINE, config);
+    std::get<TimelineAnimation>(animation_).setTimeline(&timeline);
+}
+
+bool Driver::timelineFinished() const {
+    const auto* timeline_animation = std::get_if<TimelineAnimation>(&animation_);
+    return timeline_animation && timeline_animation->finished();
 }
 
 const AnimationConfig& Driver::getAnimationConfig() const {
-    static const AnimationConfig default_config;
-    return animation_ ? animation_->getConfig() : default_config;
+    return animation().getConfig();
 }
 
 void Driver::updatePWMConfig(const PWMConfig& config) {
     pwm_driver_.updateConfig(config);
+    last_duty_ = NO_DUTY; // resolution may have changed
+    last_level_ = NO_DUTY;
 }
 
-void Driver::applyBrightness() {
-    if (!animation_) return;
-    
+void Driver::applyBrightness(time_us dt_us) {
+    if (!initialized_) return;
+
     // Get animated brightness
-    float animated_brightness = animation_->update(since_set_);
+    float animated_brightness = animation().update(dt_us);
     
-    // Apply filtering for smooth transitions
-    simpleFilterf(current_brightness_, animated_brightness, filter_value_);
+    // Apply filtering for smooth transitions (time based, independent of loop load)
+    simpleFilterDtf(current_brightness_, animated_brightness, us_to_ms_f(dt_us), filter_time_constant_ms_);
     
     // Apply gamma correction
     float corrected_brightness = applyGamma(current_brightness_);
     
-    // Set PWM output
-    pwm_driver_.set(corrected_brightness);
+    // Set PWM output, only if the quantized duty changed
+    const uint32_t level = pwm_driver_.toDuty(corrected_brightness);
+    const uint32_t duty = pwm_driver_.isDithering() ? pwm_driver_.toDitheredDuty(corrected_brightness) : level;
+    if (duty != last_duty_) {
+        last_duty_ = duty;
+        pwm_driver_.setDuty(duty);
+    } else {
+        skipped_writes_++;
+    }
     
     // Call change callback if provided
-    if (on_change_callback_) {
-        on_change_callback_(current_brightness_);
+    if (level != last_level_) {
+        last_level_ = level;
+        if (on_change_callback_) {
+            on_change_callback_(current_brightness_);
+        }
     }
 }
 
 float Driver::applyGamma(float value) const {
-    return powf(util::clipf(value, 0.0f, 1.0f), gamma_);
+    return util::lut::powf(util::clipf(value, 0.0f, 1.0f), gamma_);
 }
 
-std::unique_ptr<AnimationDriver> Driver::createAnimation(AnimationMode mode) {
+void Driver::emplaceAnimation(AnimationMode mode) {
     switch (mode) {
         case AnimationMode::STATIC:
-            return std::make_unique<StaticAnimation>(target_brightness_);
+            animation_.emplace<StaticAnimation>(target_brightness_);
+            break;
         case AnimationMode::BREATH:
-            return std::make_unique<BreathAnimation>();
+            animation_.emplace<BreathAnimation>();
+            break;
         case AnimationMode::PULSE:
-            return std::make_unique<PulseAnimation>();
+            animation_.emplace<PulseAnimation>();
+            break;
         case AnimationMode::WAVE:
-            return std::make_unique<WaveAnimation>();
+            animation_.emplace<WaveAnimation>();
+            break;
         case AnimationMode::RANDOM:
-            return std::make_unique<RandomAnimation>();
+            animation_.emplace<RandomAnimation>();
+            break;
+        case AnimationMode::TIMELINE:
+            animation_.emplace<TimelineAnimation>();
+            break;
         default:
-            return std::make_unique<StaticAnimation>(target_brightness_);
+            animation_.emplace<StaticAnimation>(target_brightness_);
+            break;
     }
 }
 
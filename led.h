@@ -3,7 +3,9 @@
 #include <elapsedMillis.h>
 #include <functional>
 #include <memory>
+#include <variant>
 #include <vector>
+#include "led_timeline.h"
 #include "pwm.h"
 #include "util.h"
 
@@ -24,7 +26,8 @@ enum class AnimationMode
     BREATH, // Breathing effect
     PULSE,  // Pulsing effect
     WAVE,   // Wave pattern
-    RANDOM  // Random brightness changes
+    RANDOM, // Random brightness changes
+    TIMELINE // Keyframe sequence (Timeline)
 };
 
 /**
@@ -63,10 +66,10 @@ public:
 
     /**
      * @brief Update animation and return current brightness
-     * @param elapsed_ms Time elapsed since last update
+     * @param elapsed_us Time elapsed since last update
      * @return Current brightness value (0.0-1.0)
      */
-    virtual float update(uint32_t elapsed_ms) = 0;
+    virtual float update(time_us elapsed_us) = 0;
 
     /**
      * @brief Reset animation to initial state
@@ -85,7 +88,20 @@ public:
 
 protected:
     AnimationConfig config_;
-    uint32_t        animation_time_ = 0;
+    time_us         animation_time_us_ = 0; // 64 bit, does not wrap
+
+    [[nodiscard]] time_us cycleTime_us() const
+    {
+        const time_us cycle = time_us(config_.period_ms * 1000.0f / config_.speed);
+        return cycle > 0 ? cycle : 1;
+    }
+
+    // 0..1 position in the current cycle
+    [[nodiscard]] float phase() const
+    {
+        const time_us cycle = cycleTime_us();
+        return float(animation_time_us_ % cycle) / float(cycle);
+    }
 };
 
 /**
@@ -100,7 +116,7 @@ public:
         static_brightness_ = brightness;
     }
 
-    float update(uint32_t elapsed_ms) override { return static_brightness_; }
+    float update(time_us elapsed_us) override { return static_brightness_; }
 
     void reset() override
     {
@@ -124,11 +140,10 @@ class BreathAnimation : public AnimationDriver
 public:
     BreathAnimation() { config_.mode = AnimationMode::BREATH; }
 
-    float update(uint32_t elapsed_ms) override
+    float update(time_us elapsed_us) override
     {
-        animation_time_ += elapsed_ms;
-        const float cycle_time = config_.period_ms / config_.speed;
-        const float phase      = (animation_time_ % static_cast<uint32_t>(cycle_time)) / cycle_time;
+        animation_time_us_ += elapsed_us;
+        const float phase = this->phase();
 
         // Use sine wave for smooth breathing effect
         const float sine_value = (sinf(phase * 2.0f * PI) + 1.0f) * 0.5f;
@@ -139,7 +154,7 @@ public:
                                    config_.max_brightness);
     }
 
-    void reset() override { animation_time_ = 0; }
+    void reset() override { animation_time_us_ = 0; }
 };
 
 /**
@@ -150,11 +165,10 @@ class PulseAnimation : public AnimationDriver
 public:
     PulseAnimation() { config_.mode = AnimationMode::PULSE; }
 
-    float update(uint32_t elapsed_ms) override
+    float update(time_us elapsed_us) override
     {
-        animation_time_ += elapsed_ms;
-        const float cycle_time = config_.period_ms / config_.speed;
-        const float phase      = (animation_time_ % static_cast<uint32_t>(cycle_time)) / cycle_time;
+        animation_time_us_ += elapsed_us;
+        const float phase = this->phase();
 
         // Use square wave for pulsing effect
         const float pulse_value = (phase < 0.5f) ? 1.0f : 0.0f;
@@ -165,7 +179,7 @@ public:
                                    config_.max_brightness);
     }
 
-    void reset() override { animation_time_ = 0; }
+    void reset() override { animation_time_us_ = 0; }
 };
 
 /**
@@ -176,11 +190,10 @@ class WaveAnimation : public AnimationDriver
 public:
     WaveAnimation() { config_.mode = AnimationMode::WAVE; }
 
-    float update(uint32_t elapsed_ms) override
+    float update(time_us elapsed_us) override
     {
-        animation_time_ += elapsed_ms;
-        const float cycle_time = config_.period_ms / config_.speed;
-        const float phase      = (animation_time_ % static_cast<uint32_t>(cycle_time)) / cycle_time;
+        animation_time_us_ += elapsed_us;
+        const float phase = this->phase();
 
         // Use triangle wave for wave effect
         const float triangle_value = (phase < 0.5f) ? phase * 2.0f : (1.0f - phase) * 2.0f;
@@ -191,7 +204,7 @@ public:
                                    config_.max_brightness);
     }
 
-    void reset() override { animation_time_ = 0; }
+    void reset() override { animation_time_us_ = 0; }
 };
 
 /**
@@ -202,22 +215,21 @@ class RandomAnimation : public AnimationDriver
 public:
     RandomAnimation()
     {
-        config_.mode = AnimationMode::RANDOM;
-        last_change_time_ = 0;
-        current_random_   = 0.5f;
+        config_.mode         = AnimationMode::RANDOM;
+        last_change_time_us_ = 0;
+        current_random_      = 0.5f;
     }
 
-    float update(uint32_t elapsed_ms) override
+    float update(time_us elapsed_us) override
     {
-        animation_time_ += elapsed_ms;
-        const uint32_t change_interval = static_cast<uint32_t>(config_.period_ms / config_.speed);
+        animation_time_us_ += elapsed_us;
 
-        if (animation_time_ - last_change_time_ >= change_interval)
+        if (animation_time_us_ - last_change_time_us_ >= cycleTime_us())
         {
             // Generate new random value
             current_random_ = static_cast<float>(random(config_.min_brightness * 1000,
                                                        config_.max_brightness * 1000)) / 1000.0f;
-            last_change_time_ = animation_time_;
+            last_change_time_us_ = animation_time_us_;
         }
 
         return current_random_;
@@ -225,16 +237,78 @@ public:
 
     void reset() override
     {
-        animation_time_    = 0;
-        last_change_time_  = 0;
+        animation_time_us_   = 0;
+        last_change_time_us_ = 0;
         current_random_    = 0.5f;
     }
 
 private:
-    uint32_t last_change_time_;
+    time_us  last_change_time_us_;
     float    current_random_;
 };
 
+/**
+ * @brief Timeline animation driver (keyframes, see led_timeline.h)
+ *
+ * Plays a compiled Timeline, values 0..1 are mapped to min..max brightness,
+ * speed scales the playback time. Holds the last value at the end unless
+ * the timeline loops. The Timeline is not copied and must outlive this.
+ */
+class TimelineAnimation : public AnimationDriver
+{
+public:
+    TimelineAnimation() { config_.mode = AnimationMode::TIMELINE; }
+
+    void setTimeline(const Timeline* timeline)
+    {
+        timeline_ = timeline;
+        reset();
+    }
+
+    float update(time_us elapsed_us) override
+    {
+        if (!timeline_)
+            return config_.min_brightness;
+
+        animation_time_us_ += config_.speed == 1.0f ? elapsed_us : time_us(elapsed_us * config_.speed);
+        const time_us duration_us = time_us(timeline_->duration_ms()) * 1000;
+        if (timeline_->loops() && duration_us > 0 && animation_time_us_ >= duration_us)
+            animation_time_us_ %= duration_us;
+
+        const float value = timeline_->evaluate(float(animation_time_us_) * 0.001f, cursor_);
+        return util::mapConstrainf(value,
+                                   0.0f,
+                                   1.0f,
+                                   config_.min_brightness,
+                                   config_.max_brightness);
+    }
+
+    void reset() override
+    {
+        animation_time_us_ = 0;
+        cursor_            = 0;
+    }
+
+    // past the last keyframe (never for a looping timeline)
+    [[nodiscard]] bool finished() const
+    {
+        return timeline_ && !timeline_->loops() && animation_time_us_ >= time_us(timeline_->duration_ms()) * 1000;
+    }
+
+private:
+    const Timeline* timeline_ = nullptr;
+    uint16_t        cursor_   = 0;
+};
+
+/**
+ * @brief Storage for one animation of any kind, in place (no heap)
+ *
+ * Switching the animation emplaces the new one, a brightness change in
+ * STATIC mode only calls StaticAnimation::setBrightness().
+ */
+using AnimationStorage =
+    std::variant<StaticAnimation, BreathAnimation, PulseAnimation, WaveAnimation, RandomAnimation, TimelineAnimation>;
+
 /**
  * @brief Main LED driver class
  */
@@ -245,6 +319,7 @@ public:
 
     void setup();
     void loop();
+    void update(); // ungated loop(), for util::Scheduler tasks
 
     void set(float percentage);
     void setDirectly(float percentage);
@@ -256,6 +331,13 @@ public:
     void setAnimation(AnimationMode mode, const AnimationConfig& config = {});
     [[nodiscard]] const AnimationConfig& getAnimationConfig() const;
 
+    /**
+     * @brief Play a keyframe timeline (TIMELINE mode), restarts it from 0
+     * @param timeline Not copied, must outlive its use here
+     */
+    void setTimeline(const Timeline& timeline, const AnimationConfig& config = {});
+    [[nodiscard]] bool timelineFinished() const;
+
     /**
      * @brief Set gamma correction
      * @param gamma Gamma value (typically 2.2-2.8)
@@ -264,9 +346,18 @@ public:
 
     /**
      * @brief Set filter value for smooth transitions
-     * @param value Filter value (0.0-1.0, lower = smoother)
+     * @param value Filter value per loop tick at LOOP_PERIOD_MS (0.0-1.0, lower = smoother)
+     */
+    void setFilterValue(float value)
+    {
+        filter_time_constant_ms_ = filterFactorToTimeConstant(value, LOOP_PERIOD_MS);
+    }
+
+    /**
+     * @brief Set smoothing as time constant, independent of the loop rate
+     * @param time_constant_ms Time to reach ~63% of a brightness step
      */
-    void setFilterValue(float value) { filter_value_ = value; }
+    void setFilterTimeConstant(float time_constant_ms) { filter_time_constant_ms_ = time_constant_ms; }
 
     /**
      * @brief Set callback for brightness changes
@@ -279,27 +370,60 @@ public:
 
     void updatePWMConfig(const PWMConfig& config);
 
+    /**
+     * @brief Temporal dithering of the PWM duty (see PWMDriver::setDithering())
+     *
+     * Smooths slow fades at the bottom of the gamma curve, where 8 bit PWM
+     * only has a few steps. The change callback still follows the undithered
+     * duty, the skipped write count only the dithered one.
+     */
+    void setDithering(bool enabled) { pwm_driver_.setDithering(enabled); }
+    [[nodiscard]] bool isDithering() const { return pwm_driver_.isDithering(); }
+
+    /**
+     * @brief Loop ticks that left the PWM output unchanged
+     *
+     * The PWM register is only written (and the change callback only called)
+     * when the duty at the PWM resolution changes.
+     */
+    [[nodiscard]] uint32_t getSkippedWrites() const { return skipped_writes_; }
+
 private:
     PWMDriver pwm_driver_;
-    std::unique_ptr<AnimationDriver> animation_;
+    AnimationStorage animation_;
     
     float target_brightness_ = 0.0f;
     float current_brightness_ = 0.0f;
     float last_target_brightness_ = 1.0f;
+
+    static constexpr uint32_t NO_DUTY = UINT32_MAX; // forces the next write
+    uint32_t last_duty_ = NO_DUTY;   // written to the PWM (dithered)
+    uint32_t last_level_ = NO_DUTY;  // for the change callback (undithered)
+    uint32_t skipped_writes_ = 0;
     
+    static constexpr uint32_t LOOP_PERIOD_MS = 3; // nominal, loop() applies every > 2 ms
+
     float gamma_ = 2.2f;
-    float filter_value_ = 0.1f;
+    float filter_time_constant_ms_ = filterFactorToTimeConstant(0.1f, LOOP_PERIOD_MS);
     
     bool initialized_ = false;
     
-    elapsedMillis since_loop_;
-    elapsedMillis since_set_;
+    util::Stopwatch since_loop_;
     
     std::function<void(float)> on_change_callback_;
     
-    void applyBrightness();
+    void applyBrightness(time_us dt_us);
     float applyGamma(float value) const;
-    std::unique_ptr<AnimationDriver> createAnimation(AnimationMode mode);
+    void emplaceAnimation(AnimationMode mode);
+
+    AnimationDriver& animation()
+    {
+        return std::visit([](auto& a) -> AnimationDriver& { return a; }, animation_);
+    }
+    const AnimationDriver& animation() const
+    {
+        return std::visit([](const auto& a) -> const AnimationDriver& { return a; }, animation_);
+    }
 };
 
 } // namespace led
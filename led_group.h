@@ -0,0 +1,324 @@
+#pragma once
+#include <Arduino.h>
+#include <cstdint>
+#include <functional>
+
+#include "led.h"
+#include "util.h"
+
+namespace util {
+namespace led {
+
+/**
+ * @brief N LED channels animated, filtered and written together (structure of arrays)
+ *
+ * Works like N util::led::Driver objects (differences below), but one
+ * update() runs every stage for all channels before the next one:
+ * animations in one loop per mode (no virtual calls, channels are grouped
+ * by mode when setAnimation() changes), the filter and the gamma table
+ * lookup in one loop each, then all PWM writes. 16 channels cost about what
+ * a single Driver did.
+ *
+ * Differences to Driver: filter time constant and gamma are per group,
+ * the animation phase is a float (0..1) advanced by dt instead of a 64 bit
+ * time, gamma comes from a 64 segment table (InterpolatedLut). There is no
+ * on-change callback (poll getCurrent()/getDuty() instead) and no dithering
+ * (setDithering()). checkLedGroup() in host/benchmark_suite.h compares the
+ * duties with N Drivers.
+ *
+ * Usage:
+ *
+ * util::led::Group<16> leds;
+ *
+ * void setup() {
+ *   for (int n = 0; n < 16; n++)
+ *     leds.setup(n, util::led::PWMConfig(pins[n]));
+ *   leds.setAnimation(3, util::led::AnimationMode::BREATH);
+ * }
+ *
+ * void loop() {
+ *   leds.set(0, 0.5f);
+ *   leds.loop(); // every LOOP_PERIOD_MS, like Driver::loop()
+ * }
+ */
+template <int N>
+class Group
+{
+public:
+    static constexpr int      size() { return N; }
+    static constexpr uint32_t LOOP_PERIOD_MS = 3; // same as Driver
+    static constexpr int      MODES          = int(AnimationMode::TIMELINE) + 1;
+
+    Group()
+    {
+        for (int n = 0; n < N; n++)
+        {
+            _attached[n]  = false;
+            _pin[n]       = 0;
+            _max_value[n] = 255;
+            _target[n]    = 0;
+            _current[n]   = 0;
+            _animated[n]  = 0;
+            _duty[n]      = 0; // PWMDriver::setup() writes 0
+            _changed[n]   = false;
+            _phase[n]     = 0;
+            _random[n]    = 0.5f;
+            _timeline[n]  = nullptr;
+            _cursor[n]    = 0;
+            _time_us[n]   = 0;
+            _mode[n]      = AnimationMode::STATIC;
+            setConfig(n, AnimationConfig());
+        }
+        setGamma(2.2f);
+        regroup();
+    }
+
+    // PWM hardware setup of one channel (pin, frequency, resolution)
+    void setup(int channel, const PWMConfig& config)
+    {
+        _pwm[channel].setup(config);
+        _attached[channel]  = true;
+        _pin[channel]       = config.pin;
+        _max_value[channel] = (1U << config.resolution_bits) - 1;
+        _duty[channel]      = 0; // written by setup()
+        _initialized        = true;
+    }
+
+    void set(int channel, float percentage) { _target[channel] = util::clipf(percentage, 0.0f, 1.0f); }
+
+    void setDirectly(int channel, float percentage)
+    {
+        set(channel, percentage);
+        _current[channel] = _target[channel];
+    }
+
+    [[nodiscard]] float get(int channel) const { return _target[channel]; }
+    [[nodiscard]] float getCurrent(int channel) const { return _current[channel]; }
+    [[nodiscard]] uint32_t getDuty(int channel) const { return _duty[channel]; }
+
+    void setAnimation(int channel, AnimationMode mode, const AnimationConfig& config = {})
+    {
+        _mode[channel]    = mode;
+        _phase[channel]   = 0;
+        _random[channel]  = 0.5f;
+        _cursor[channel]  = 0;
+        _time_us[channel] = 0;
+        setConfig(channel, config);
+        regroup();
+    }
+
+    // TIMELINE mode on one channel, timeline is not copied (see Driver::setTimeline())
+    void setTimeline(int channel, const Timeline& timeline, const AnimationConfig& config = {})
+    {
+        setAnimation(channel, AnimationMode::TIMELINE, config);
+        _timeline[channel] = &timeline;
+    }
+
+    [[nodiscard]] AnimationMode getAnimation(int channel) const { return _mode[channel]; }
+
+    // gamma of all channels, rebuilds the table (not in the loop)
+    void setGamma(float gamma)
+    {
+        _gamma.build([gamma](float x) { return ::powf(x, gamma); }, 0.0f, 1.0f);
+    }
+
+    void setFilterValue(float value) { _filter_time_constant_ms = filterFactorToTimeConstant(value, LOOP_PERIOD_MS); }
+    void setFilterTimeConstant(float time_constant_ms) { _filter_time_constant_ms = time_constant_ms; }
+
+    void loop()
+    {
+        if (_since_loop.elapsed_ms() >= time_ms(LOOP_PERIOD_MS))
+            update();
+    }
+
+    // ungated loop(), for util::Scheduler tasks
+    void update() { update(_since_loop.restart()); }
+
+    // one frame of dt_us for all channels
+    void update(time_us dt_us)
+    {
+        if (!_initialized)
+            return;
+
+        animate(dt_us);
+
+        // filter, same as simpleFilterDtf(), one factor for all channels
+        const float alpha = filterFactorFromTime(us_to_ms_f(dt_us), _filter_time_constant_ms);
+        for (int n = 0; n < N; n++)
+        {
+            const float diff = _animated[n] - _current[n];
+            _current[n]      = std::fabs(diff) <= LAST_STEP ? _animated[n] : _current[n] + diff * alpha;
+        }
+
+        for (int n = 0; n < N; n++)
+        {
+            const uint32_t duty = uint32_t(_gamma(_current[n]) * float(_max_value[n]));
+            _changed[n]         = duty != _duty[n];
+            _duty[n]            = duty;
+        }
+
+        // only changed duties, like Driver
+        for (int n = 0; n < N; n++)
+        {
+            if (!_attached[n])
+                continue;
+            if (_changed[n])
+                write(_pin[n], _duty[n]);
+            else
+                _skipped_writes++;
+        }
+    }
+
+    // channel writes left out because the duty did not change
+    [[nodiscard]] uint32_t getSkippedWrites() const { return _skipped_writes; }
+
+private:
+    static constexpr float LAST_STEP = 0.01f; // simpleFilterf() default
+
+    PWMDriver _pwm[N]; // hardware setup only, duties are written directly
+
+    // per channel state, one array per field
+    bool            _attached[N];
+    uint8_t         _pin[N];
+    uint32_t        _max_value[N];
+    float           _target[N];
+    float           _current[N];
+    float           _animated[N];
+    uint32_t        _duty[N];
+    bool            _changed[N];      // _duty differs from the last frame
+    AnimationMode   _mode[N];
+    float           _min[N];
+    float           _range[N];        // max - min brightness
+    float           _phase_per_us[N]; // 1 / cycle time
+    float           _phase[N];        // 0..1
+    float           _random[N];
+    float           _speed[N];
+    const Timeline* _timeline[N];
+    uint16_t        _cursor[N];
+    time_us         _time_us[N];      // timeline position
+
+    // channel numbers by mode, rebuilt by setAnimation()
+    uint8_t _members[MODES][N];
+    int     _count[MODES] = {};
+
+    InterpolatedLut<64> _gamma;
+    float               _filter_time_constant_ms = filterFactorToTimeConstant(0.1f, LOOP_PERIOD_MS);
+    bool                _initialized             = false;
+    uint32_t            _skipped_writes          = 0;
+    util::Stopwatch     _since_loop;
+
+    static const InterpolatedLut<64>& breathTable()
+    {
+        static const InterpolatedLut<64> table = [] {
+            InterpolatedLut<64> t;
+            t.build([](float phase) { return (sinf(phase * 2.0f * PI) + 1.0f) * 0.5f; }, 0.0f, 1.0f);
+            return t;
+        }();
+        return table;
+    }
+
+    void setConfig(int channel, const AnimationConfig& config)
+    {
+        const float cycle_us   = config.period_ms * 1000.0f / config.speed;
+        _min[channel]          = config.min_brightness;
+        _range[channel]        = config.max_brightness - config.min_brightness;
+        _phase_per_us[channel] = cycle_us > 1.0f ? 1.0f / cycle_us : 1.0f;
+        _speed[channel]        = config.speed;
+    }
+
+    void regroup()
+    {
+        for (int m = 0; m < MODES; m++)
+            _count[m] = 0;
+        for (int n = 0; n < N; n++)
+        {
+            const int m              = int(_mode[n]);
+            _members[m][_count[m]++] = uint8_t(n);
+        }
+    }
+
+    // advances the phase, true once per cycle
+    bool advance(int n, float dt_us)
+    {
+        float      phase   = _phase[n] + dt_us * _phase_per_us[n];
+        const bool wrapped = phase >= 1.0f;
+        if (wrapped)
+            phase -= floorf(phase);
+        _phase[n] = phase;
+        return wrapped;
+    }
+
+    void animate(time_us dt_us)
+    {
+        const float dt = float(dt_us);
+
+        const uint8_t* members = _members[int(AnimationMode::STATIC)];
+        for (int i = 0; i < _count[int(AnimationMode::STATIC)]; i++)
+            _animated[members[i]] = _target[members[i]];
+
+        const InterpolatedLut<64>& breath = breathTable();
+        members                           = _members[int(AnimationMode::BREATH)];
+        for (int i = 0; i < _count[int(AnimationMode::BREATH)]; i++)
+        {
+            const int n = members[i];
+            advance(n, dt);
+            _animated[n] = _min[n] + breath(_phase[n]) * _range[n];
+        }
+
+        members = _members[int(AnimationMode::PULSE)];
+        for (int i = 0; i < _count[int(AnimationMode::PULSE)]; i++)
+        {
+            const int n = members[i];
+            advance(n, dt);
+            _animated[n] = _min[n] + (_phase[n] < 0.5f ? _range[n] : 0.0f);
+        }
+
+        members = _members[int(AnimationMode::WAVE)];
+        for (int i = 0; i < _count[int(AnimationMode::WAVE)]; i++)
+        {
+            const int n = members[i];
+            advance(n, dt);
+            const float triangle = _phase[n] < 0.5f ? _phase[n] * 2.0f : (1.0f - _phase[n]) * 2.0f;
+            _animated[n]         = _min[n] + triangle * _range[n];
+        }
+
+        members = _members[int(AnimationMode::RANDOM)];
+        for (int i = 0; i < _count[int(AnimationMode::RANDOM)]; i++)
+        {
+            const int n = members[i];
+            if (advance(n, dt))
+                _random[n] = float(random(_min[n] * 1000, (_min[n] + _range[n]) * 1000)) / 1000.0f;
+            _animated[n] = _random[n];
+        }
+
+        members = _members[int(AnimationMode::TIMELINE)];
+        for (int i = 0; i < _count[int(AnimationMode::TIMELINE)]; i++)
+        {
+            const int       n        = members[i];
+            const Timeline* timeline = _timeline[n];
+            if (!timeline)
+            {
+                _animated[n] = _min[n];
+                continue;
+            }
+            _time_us[n] += _speed[n] == 1.0f ? dt_us : time_us(dt * _speed[n]);
+            const time_us duration_us = time_us(timeline->duration_ms()) * 1000;
+            if (timeline->loops() && duration_us > 0 && _time_us[n] >= duration_us)
+                _time_us[n] %= duration_us;
+            const float value = timeline->evaluate(float(_time_us[n]) * 0.001f, _cursor[n]);
+            _animated[n]      = _min[n] + util::clipf(value, 0.0f, 1.0f) * _range[n];
+        }
+    }
+
+    static void write(uint8_t pin, uint32_t duty)
+    {
+#ifdef ARDUINO_ARCH_ESP32
+        ledcWrite(pin, duty);
+#else
+        analogWrite(pin, duty);
+#endif
+    }
+};
+
+} // namespace led
+} // namespace util
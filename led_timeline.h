@@ -0,0 +1,211 @@
+#pragma once
+#include <Arduino.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace util {
+namespace led {
+
+/**
+ * @brief Keyframe sequence compiled into a table of cubic segments
+ *
+ * Every add() compiles the curve from the previous keyframe into one or more
+ * segments with polynomial coefficients, so evaluate() is a table lookup
+ * (a cursor that only moves forward) and a cubic in Horner form, no powf/exp
+ * per tick. LOG is approximated by 4 Hermite pieces of the exact curve
+ * (max error ~1e-3 of the step).
+ *
+ * Values go through the driver's gamma afterwards (Driver::setGamma, 2.2 by
+ * default), which already makes LINEAR look roughly even to the eye. LOG on
+ * top of it lingers longer in the dark part, for an exponential brightness
+ * curve on its own use setGamma(1).
+ *
+ * Replaces fades precomputed into arrays (see server/graphs_helper.h), plays
+ * on a util::led::Driver via setTimeline() or a Group channel. Load it from
+ * SPIFFS with server/timeline_file.h.
+ *
+ * Usage:
+ *
+ * util::led::Timeline sunrise;
+ * sunrise.add(0, 0.0f);
+ * sunrise.add(20 * 60000, 0.3f, util::led::Timeline::Curve::LOG);  // 20 min, slow start
+ * sunrise.add(30 * 60000, 1.0f, util::led::Timeline::Curve::EASE); // 10 min more
+ * led.setTimeline(sunrise); // sunrise must outlive the animation
+ */
+class Timeline
+{
+public:
+    // shape from the previous keyframe to this one
+    enum class Curve : uint8_t
+    {
+        STEP,   // hold the previous value, jump at the keyframe
+        LINEAR,
+        EASE,   // smoothstep, zero slope at both ends
+        LOG,    // exponential in the value, slow at the low end (rising and falling)
+    };
+
+    static constexpr int   MAX_SEGMENTS = 48;
+    static constexpr int   LOG_PIECES   = 4;
+    static constexpr float LOG_RANGE    = 5.0f; // 2^5 = 32:1 from the start to the end of a LOG step
+
+    void clear()
+    {
+        _count     = 0;
+        _keyframes = 0;
+        _end_ms    = 0;
+        _end_value = 0;
+    }
+
+    /**
+     * @brief Append a keyframe, times in increasing order
+     * @return false if the time goes back or the segment table is full
+     */
+    bool add(uint32_t time_ms, float value, Curve curve = Curve::LINEAR)
+    {
+        if (_keyframes == 0)
+        {
+            _start_ms  = float(time_ms);
+            _end_ms    = time_ms;
+            _end_value = value;
+            _keyframes = 1;
+            return true;
+        }
+        if (time_ms <= _end_ms)
+        {
+            printf("ERROR in util::led::Timeline::add: %u ms is not after %u ms\n", unsigned(time_ms), unsigned(_end_ms));
+            return false;
+        }
+        const int needed = curve == Curve::LOG ? LOG_PIECES : 1;
+        if (_count + needed > MAX_SEGMENTS)
+        {
+            printf("ERROR in util::led::Timeline::add: more than %d segments\n", MAX_SEGMENTS);
+            return false;
+        }
+
+        const float t0 = float(_end_ms);
+        const float t1 = float(time_ms);
+        const float v0 = _end_value;
+        const float dv = value - v0;
+
+        switch (curve)
+        {
+        case Curve::STEP:
+            push(t0, t1, v0, 0, 0, 0);
+            break;
+        case Curve::LINEAR:
+            push(t0, t1, v0, dv, 0, 0);
+            break;
+        case Curve::EASE:
+            push(t0, t1, v0, 0, 3 * dv, -2 * dv);
+            break;
+        case Curve::LOG:
+            for (int p = 0; p < LOG_PIECES; p++)
+            {
+                // Hermite piece of v0 + dv * w(u), values and slopes exact at both ends
+                const bool  falling = dv < 0; // mirrored, a fade-down drops fast first
+                const float u0      = float(p) / LOG_PIECES;
+                const float u1      = float(p + 1) / LOG_PIECES;
+                const float p0      = logCurve(u0, falling);
+                const float p1      = logCurve(u1, falling);
+                const float m0      = logSlope(u0, falling) / LOG_PIECES;
+                const float m1      = logSlope(u1, falling) / LOG_PIECES;
+                push(t0 + (t1 - t0) * u0,
+                     t0 + (t1 - t0) * u1,
+                     v0 + dv * p0,
+                     dv * m0,
+                     dv * (3 * (p1 - p0) - 2 * m0 - m1),
+                     dv * (2 * (p0 - p1) + m0 + m1));
+            }
+            break;
+        }
+
+        _end_ms    = time_ms;
+        _end_value = value;
+        _keyframes++;
+        return true;
+    }
+
+    /**
+     * @brief Value at t_ms, first/last keyframe value outside of the sequence
+     * @param cursor per player, starts at 0; forward playback is amortized O(1)
+     */
+    float evaluate(float t_ms, uint16_t& cursor) const
+    {
+        if (_count == 0)
+            return _end_value;
+        if (t_ms <= _start_ms)
+            return _segments[0].c[0];
+        if (t_ms >= float(_end_ms))
+            return _end_value;
+
+        if (cursor >= _count || t_ms < _segments[cursor].t0)
+            cursor = 0; // went back (loop, reset)
+        while (cursor + 1 < _count && t_ms >= _segments[cursor + 1].t0)
+            cursor++;
+
+        const Segment& s = _segments[cursor];
+        float          u = (t_ms - s.t0) * s.inv_duration;
+        if (u > 1.0f)
+            u = 1.0f;
+        return s.c[0] + u * (s.c[1] + u * (s.c[2] + u * s.c[3]));
+    }
+
+    float evaluate(float t_ms) const
+    {
+        uint16_t cursor = 0;
+        return evaluate(t_ms, cursor);
+    }
+
+    void setLoop(bool loop) { _loop = loop; }
+    bool loops() const { return _loop; }
+
+    uint32_t duration_ms() const { return _end_ms; }
+    int      keyframes() const { return _keyframes; }
+    int      segments() const { return _count; }
+
+    // "step", "linear", "ease", "log", false if unknown
+    static bool curveFromName(const char* name, Curve& curve)
+    {
+        static const char* const NAMES[] = {"step", "linear", "ease", "log"};
+        for (uint8_t i = 0; i < 4; i++)
+            if (strcmp(name, NAMES[i]) == 0)
+            {
+                curve = Curve(i);
+                return true;
+            }
+        return false;
+    }
+
+private:
+    struct Segment
+    {
+        float t0;
+        float inv_duration;
+        float c[4]; // value = c0 + c1 u + c2 u^2 + c3 u^3, u = 0..1 over the segment
+    };
+
+    Segment  _segments[MAX_SEGMENTS];
+    uint16_t _count     = 0;
+    uint16_t _keyframes = 0;
+    float    _start_ms  = 0;
+    uint32_t _end_ms    = 0;
+    float    _end_value = 0;
+    bool     _loop      = false;
+
+    void push(float t0, float t1, float c0, float c1, float c2, float c3)
+    {
+        _segments[_count++] = {t0, 1.0f / (t1 - t0), {c0, c1, c2, c3}};
+    }
+
+    // 0..1 -> 0..1, only used while compiling
+    static float logCurve(float u) { return (exp2f(LOG_RANGE * u) - 1.0f) / (exp2f(LOG_RANGE) - 1.0f); }
+    static float logSlope(float u) { return LOG_RANGE * float(M_LN2) * exp2f(LOG_RANGE * u) / (exp2f(LOG_RANGE) - 1.0f); }
+
+    // falling: 1 - w(1 - u), the slow part stays at the low value
+    static float logCurve(float u, bool falling) { return falling ? 1.0f - logCurve(1.0f - u) : logCurve(u); }
+    static float logSlope(float u, bool falling) { return logSlope(falling ? 1.0f - u : u); }
+};
+
+} // namespace led
+} // namespace util
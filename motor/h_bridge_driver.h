@@ -52,9 +52,16 @@ public:
     {
         }
 
+    // filter value per loop tick at LOOP_PERIOD_MS (0.0-1.0, lower = smoother)
     void setFilterValue(float value)
     {
-        _filterValue = value;
+        _filterTimeConstant_ms = filterFactorToTimeConstant(value, LOOP_PERIOD_MS);
+    }
+
+    // time to reach ~63% of a speed step, independent of the loop rate
+    void setFilterTimeConstant(float time_constant_ms)
+    {
+        _filterTimeConstant_ms = time_constant_ms;
     }
 
     void begin() // legacy
@@ -65,10 +72,15 @@ public:
     void loop()
     {
         if (_since_loop > 2)
-        {
-            _since_loop = 0;
-            applySpeed();
-        }
+            update();
+    }
+
+    // ungated loop(), for util::Scheduler tasks
+    void update()
+    {
+        const uint32_t dt_ms = _since_loop;
+        _since_loop = 0;
+        applySpeed(dt_ms);
     }
 
     void setPowerPercentage(float percentage)
@@ -94,9 +106,9 @@ public:
         applySpeed();
     }
 
-    void applySpeed()
+    void applySpeed(uint32_t dt_ms = LOOP_PERIOD_MS)
     {
-        simpleFilterf(_current, _target, _filterValue);
+        simpleFilterDtf(_current, _target, dt_ms, _filterTimeConstant_ms);
         float output = (_invert_dir ? -1 : 1) * _current;
 
         if (output > 0)
@@ -138,7 +150,9 @@ private:
     float _target = 0;
     float _current = 0;
 
-    float _filterValue = 0.02f;
+    static constexpr uint32_t LOOP_PERIOD_MS = 3; // nominal, loop() applies every > 2 ms
+
+    float _filterTimeConstant_ms = filterFactorToTimeConstant(0.02f, LOOP_PERIOD_MS);
 
     PWM_Driver _pwm1;
     PWM_Driver _pwm2;
@@ -1,16 +1,149 @@
 #pragma once
 #include "basics.h"
+#include "filter.h"
 
 using namespace util;
 
-class PID
+enum class PIDDerivativeFilterType
 {
+    NONE,
+    ONE_POLE,      // exponential smoothing
+    BIQUAD,        // 2nd order butterworth low-pass
+    MOVING_AVERAGE // box filter, window = sample_rate / cutoff (max MAX_WINDOW)
+};
+
+/**
+ * @brief Low-pass applied to the derivative term of PID (per instance)
+ *
+ * cutoff_hz == 0 keeps the legacy one-pole with a fixed factor of 0.1 per
+ * sample, otherwise coefficients are derived from the cutoff and the PID
+ * sample rate (recomputed in PID::setSampleRate).
+ *
+ * T = float or a util::fixed type (coefficients are computed in float at
+ * setup and converted once).
+ */
+template <typename T = float>
+class PIDDerivativeFilter_T
+{
+public:
+    using Type = PIDDerivativeFilterType;
+
+    static constexpr int MAX_WINDOW = 16;
+
+    void setup(Type type, float cutoff_hz, int sample_rate)
+    {
+        _type      = type;
+        _cutoff_hz = cutoff_hz;
+        setSampleRate(sample_rate);
+        reset();
+    }
+
+    static float onePoleAlpha(float cutoff_hz, int sample_rate)
+    {
+        const float fs = float(sample_rate);
+        const float fc = (cutoff_hz > 0) ? clipf(cutoff_hz, 0.0f, fs * 0.45f) : 0.0f;
+
+        if (fc <= 0)
+            return 0.1f; // legacy "super simple quick filter"
+        return 1.0f - expf(-2.0f * float(M_PI) * fc / fs);
+    }
+
+    void setSampleRate(int sample_rate)
+    {
+        const float fs = float(sample_rate);
+        const float fc = (_cutoff_hz > 0) ? clipf(_cutoff_hz, 0.0f, fs * 0.45f) : 0.0f;
+
+        const float alpha_f = onePoleAlpha(_cutoff_hz, sample_rate);
+        _alpha              = T(alpha_f);
+
+        if (_type == Type::BIQUAD)
+        {
+            if (fc <= 0) // no cutoff given, fall back to the one-pole cutoff
+            {
+                _cutoff_hz = -logf(1.0f - alpha_f) * fs / (2.0f * float(M_PI));
+                setSampleRate(sample_rate);
+                return;
+            }
+            _biquad.setup(util::filter::BiquadType::LOW_PASS, fc, fs);
+        }
+
+        if (_type == Type::MOVING_AVERAGE)
+        {
+            const int window = (fc > 0) ? int(fs / fc + 0.5f) : int(1.0f / alpha_f + 0.5f);
+            _moving_average.setWindow(window);
+            _moving_average.reset();
+        }
+    }
+
+    T process(T x)
+    {
+        switch (_type)
+        {
+            case Type::NONE:
+                return x;
+
+            case Type::ONE_POLE:
+                _y += (x - _y) * _alpha;
+                return _y;
+
+            case Type::BIQUAD:
+                _y = _biquad.process(x);
+                return _y;
+
+            case Type::MOVING_AVERAGE:
+                _y = _moving_average.process(x);
+                return _y;
+        }
+        return x;
+    }
+
+    void reset()
+    {
+        _y = 0;
+        _biquad.reset();
+        _moving_average.reset();
+    }
+
+    Type  type() const { return _type; }
+    float cutoff() const { return _cutoff_hz; }
+    T     alpha() const { return _alpha; }
+    T     value() const { return _y; }
+
+private:
+    Type  _type      = Type::ONE_POLE;
+    float _cutoff_hz = 0;
+
+    T _y = 0; // last output
+
+    // one-pole
+    T _alpha = T(0.1f);
+
+    util::filter::Biquad<T>                    _biquad;
+    util::filter::MovingAverage<MAX_WINDOW, T> _moving_average{1};
+};
+
+using PIDDerivativeFilter = PIDDerivativeFilter_T<float>;
+
+/**
+ * @brief PID controller
+ *
+ * T = float (PID) or a util::fixed type from fixed_point.h for targets
+ * without FPU, e.g. PID_T<util::q16_16> or PID_T<util::real_t>.
+ * q15 does not fit: the sample rate (1000), the derivative scale and the
+ * integrator limit (+-20) are outside [-1, 1), use q15 for filters only.
+ */
+template <typename T = float>
+class PID_T
+{
+    static_assert(float(T(1000)) == 1000.0f && float(T(-20)) == -20.0f,
+                  "PID_T needs a type that holds the sample rate, e.g. util::q16_16 (not util::q15)");
+
 public:
-    float process(float in)
+    T process(T in)
     {
         _input = in;
         _error = _target - _input;
-        float delta = _input - _input_z1;
+        T delta = _input - _input_z1;
         _output = process_internal(delta);
 
         _input_z1 = _input;
@@ -18,18 +151,18 @@ public:
         return _output;
     }
 
-    float process(float in, float t)
+    T process(T in, T t)
     {
         setTarget(t);
         return process(in);
     }
 
     // TODO maybe subclass this.
-    float process_unwrap(float in)
+    T process_unwrap(T in)
     {
         _input = in;
-        _error = wrap(_target - _input, -0.5f, 0.5f);
-        float delta = wrap(_input - _input_z1, -0.5f, 0.5f);
+        _error = wrap(T(_target - _input), T(-0.5f), T(0.5f));
+        T delta = wrap(T(_input - _input_z1), T(-0.5f), T(0.5f));
         _output = process_internal(delta);
 
         _input_z1 = _input;
@@ -37,58 +170,72 @@ public:
         return _output;
     }
 
-    float process_internal(float delta_in)
+    T process_internal(T delta_in)
     {
-        _output_ki += _ki * _error / float(_processRate);
-        _output_ki = clipf(_output_ki, -20, 20);
+        _output_ki += _ki * _error / T(_processRate);
+        _output_ki = clip<T>(_output_ki, T(-20), T(20));
 
         _output = 0;
         _output += _kp * _error;
         _output += _output_ki;
-#if 1
-        static float delta = 0;
-        delta += (delta_in - delta) * 0.1; // super simple quick filter
-        delta_in = delta;
-#endif
-        _output += _kd * delta_in * float(_processRate) / 1000.0;
+        delta_in = _d_filter.process(delta_in);
+        _output += _kd * delta_in * T(_processRate) / T(1000);
 
         _input_z1 = _input;
 
         return _output;
     }
 
-    void setParams(float Kp, float Ki, float Kd)
+    void setParams(T Kp, T Ki, T Kd)
     {
         _kp = Kp;
         _ki = Ki;
         _kd = Kd;
     }
-    void setSampleRate(int rate) { _processRate = rate; }
+    void setSampleRate(int rate)
+    {
+        _processRate = rate;
+        _d_filter.setSampleRate(rate);
+    }
+
+    /**
+     * @brief Configure the low-pass on the derivative term
+     * @param cutoff_hz 0 = legacy fixed factor (0.1 per sample)
+     */
+    void setDerivativeFilter(PIDDerivativeFilterType type, float cutoff_hz = 0)
+    {
+        _d_filter.setup(type, cutoff_hz, _processRate);
+    }
 
     void reset()
     {
         _output_ki = 0;
         _input_z1 = _input;
+        _d_filter.reset();
     }
 
-    void setTarget(float t)
+    void setTarget(T t)
     {
         _target = t;
-        _error = 1.0;
+        _error = T(1.0);
     }
 
 public:
-    float _target = 0;
-    float _error = 0;
+    T _target = 0;
+    T _error = 0;
 
-    float _kp; // * (P)roportional Tuning Parameter
-    float _ki; // * (I)ntegral Tuning Parameter
-    float _kd; // * (D)erivative Tuning Parameter
+    T _kp; // * (P)roportional Tuning Parameter
+    T _ki; // * (I)ntegral Tuning Parameter
+    T _kd; // * (D)erivative Tuning Parameter
 
-    float _input = 0;
-    float _output = 0;
+    T _input = 0;
+    T _output = 0;
 
-    float _output_ki, _input_z1;
+    T _output_ki = 0, _input_z1 = 0;
 
     int _processRate = 1000; // = sample rate
+
+    PIDDerivativeFilter_T<T> _d_filter;
 };
+
+using PID = PID_T<float>;
@@ -0,0 +1,144 @@
+#pragma once
+#include "pid.h"
+
+/**
+ * @brief N PID controllers stepped together (structure of arrays).
+ *
+ * Same math as PID::process, per channel, in the same operation order
+ * (derivative filter: one-pole only, see setDerivativeCutoff). Without FMA
+ * contraction (-ffp-contract=off) every channel is bit-identical to a scalar
+ * PID fed the same inputs, otherwise the compiler may fuse differently in
+ * the two and results differ by rounding, < 1e-5 relative
+ * (util::bench::checkPidBank() in host/benchmark_suite.h).
+ * All state lives in contiguous per-field arrays and process() is a set of
+ * branch-free loops over them, which GCC/Clang auto-vectorize on hosts with
+ * SSE/NEON (build with -O2/-O3) and which stay cache friendly on MCUs.
+ *
+ * Usage:
+ *
+ * PIDBank<4> pids;
+ * pids.setParams(0, 1.2, 0.5, 0.05); // per channel
+ * pids.setTarget(0, 0.25);
+ *
+ * float in[4], out[4];
+ * pids.process(in, out);
+ */
+template <int N>
+class PIDBank
+{
+public:
+    PIDBank()
+    {
+        for (int n = 0; n < N; n++)
+            _d_alpha[n] = PIDDerivativeFilter::onePoleAlpha(0, _processRate);
+    }
+
+    static constexpr int size() { return N; }
+
+    void process(const float* __restrict in, float* __restrict out)
+    {
+        const float rate = float(_processRate);
+
+        for (int n = 0; n < N; n++)
+        {
+            _input[n] = in[n];
+            _error[n] = _target[n] - in[n];
+        }
+
+        for (int n = 0; n < N; n++)
+        {
+            const float delta_in = _input[n] - _input_z1[n];
+
+            float ki = _output_ki[n];
+            ki += _ki[n] * _error[n] / rate;
+            ki = ki < -20.0f ? -20.0f : (ki > 20.0f ? 20.0f : ki); // == clipf(ki, -20, 20)
+            _output_ki[n] = ki;
+
+            float o = 0;
+            o += _kp[n] * _error[n];
+            o += ki;
+
+            float d = _delta[n];
+            d += (delta_in - d) * _d_alpha[n]; // == PIDDerivativeFilter::Type::ONE_POLE
+            _delta[n] = d;
+
+            o += _kd[n] * d * rate / 1000.0f;
+
+            _output[n] = o;
+            out[n]     = o;
+        }
+
+        for (int n = 0; n < N; n++)
+            _input_z1[n] = _input[n];
+    }
+
+    void setParams(int n, float Kp, float Ki, float Kd)
+    {
+        _kp[n] = Kp;
+        _ki[n] = Ki;
+        _kd[n] = Kd;
+    }
+
+    void setParams(float Kp, float Ki, float Kd)
+    {
+        for (int n = 0; n < N; n++)
+            setParams(n, Kp, Ki, Kd);
+    }
+
+    void setSampleRate(int rate)
+    {
+        _processRate = rate;
+        for (int n = 0; n < N; n++)
+            _d_alpha[n] = PIDDerivativeFilter::onePoleAlpha(_d_cutoff[n], rate);
+    }
+
+    /**
+     * @brief One-pole derivative low-pass per channel (same as PID::setDerivativeFilter)
+     * @param cutoff_hz 0 = legacy fixed factor (0.1 per sample)
+     */
+    void setDerivativeCutoff(int n, float cutoff_hz)
+    {
+        _d_cutoff[n] = cutoff_hz;
+        _d_alpha[n]  = PIDDerivativeFilter::onePoleAlpha(cutoff_hz, _processRate);
+        _delta[n]    = 0;
+    }
+
+    void setTarget(int n, float t)
+    {
+        _target[n] = t;
+        _error[n]  = 1.0;
+    }
+
+    void reset(int n)
+    {
+        _output_ki[n] = 0;
+        _input_z1[n]  = _input[n];
+        _delta[n]     = 0;
+    }
+
+    void reset()
+    {
+        for (int n = 0; n < N; n++)
+            reset(n);
+    }
+
+    float target(int n) const { return _target[n]; }
+    float error(int n) const { return _error[n]; }
+    float output(int n) const { return _output[n]; }
+
+public:
+    alignas(16) float _target[N]    = {};
+    alignas(16) float _error[N]     = {};
+    alignas(16) float _kp[N]        = {};
+    alignas(16) float _ki[N]        = {};
+    alignas(16) float _kd[N]        = {};
+    alignas(16) float _input[N]     = {};
+    alignas(16) float _output[N]    = {};
+    alignas(16) float _output_ki[N] = {};
+    alignas(16) float _input_z1[N]  = {};
+    alignas(16) float _delta[N]     = {}; // derivative filter state
+    alignas(16) float _d_alpha[N]   = {};
+    float             _d_cutoff[N]  = {}; // 0 = legacy factor
+
+    int _processRate = 1000; // = sample rate
+};
@@ -1,17 +1,23 @@
 #pragma once
 #include "pid.h"
 #include "util.h"
-#include <elapsedMillis.h>
 
 using namespace util;
 
-class PID_position : public PID
+/**
+ * @brief PID that fades its output out once the target is reached and stable
+ *
+ * T = float (PID_position) or a util::fixed type, see PID_T.
+ */
+template <typename T = float>
+class PID_position_T : public PID_T<T>
 {
 public:
+    using PID_T<T>::_error;
 
-    float process(float in)
+    T process(T in)
     {
-        float out = PID::process(in);
+        T out = PID_T<T>::process(in);
 
         // TODO mechanism to switch off when position is reached.
         if (fabs(_error) < _target_range)
@@ -19,18 +25,19 @@ public:
             if (!_in_target_range)
             {
                 _in_target_range = true;
-                _since_in_target_range = 0;
+                _since_in_target_range.reset();
             }
-            if (_since_in_target_range > 50)
+            const time_ms in_range_ms = _since_in_target_range.elapsed_ms();
+            if (in_range_ms > 50)
             {
-                _amplitude_factor = 1.0 - mapConstrainf(_since_in_target_range, 50, 300, 0, 1);
+                _amplitude_factor = T(1.0) - T(mapConstrainf(float(in_range_ms), 50, 300, 0, 1));
                 // setVoltageAmplitude(fade_factor);
                 out *= _amplitude_factor;
             }
-            if (_since_in_target_range > _time_stable)
+            if (in_range_ms > _time_stable)
             {
                 out = 0;
-                _amplitude_factor = 0.0;
+                _amplitude_factor = T(0.0);
             }
         }
         else
@@ -41,7 +48,7 @@ public:
 
     bool positionReached()
     {
-        bool condition = (_in_target_range && _since_in_target_range > _time_stable);
+        bool condition = (_in_target_range && _since_in_target_range.elapsed_ms() > _time_stable);
 
         if (!_position_reached && condition)
         {
@@ -52,17 +59,17 @@ public:
             return false;
     }
     
-    float amplitudeFactor() { return _amplitude_factor; }
+    T amplitudeFactor() { return _amplitude_factor; }
 
-    void setTarget(float t)
+    void setTarget(T t)
     {
-        _amplitude_factor = 1.0;
+        _amplitude_factor = T(1.0);
         _position_reached = false;
         _in_target_range = false;
-        PID::setTarget(t);
+        PID_T<T>::setTarget(t);
     }
 
-    void setParams_StableInRange(float start_fade, float time_stable, float target_range)
+    void setParams_StableInRange(float start_fade, float time_stable, T target_range)
     {
         _time_start_fade = start_fade;
         _time_stable = time_stable;
@@ -73,14 +80,16 @@ public:
     // parameters
     time_ms _time_start_fade = 60; 
     time_ms _time_stable = 300;
-    float _target_range = 0.15;
+    T _target_range = T(0.15);
 
     // ====================================================================
-    float _amplitude_factor = 1.0; // used to fade out after position is reached.
+    T _amplitude_factor = T(1.0); // used to fade out after position is reached.
 
-    elapsedMillis _since_in_target_range = 0;
+    util::Stopwatch _since_in_target_range;
     bool _in_target_range = false;
     bool _position_reached = false; // for bool getter
 
 protected:
 };
+
+using PID_position = PID_position_T<float>;
@@ -31,6 +31,7 @@ void PWMDriver::initializeHardware() {
 #endif
     
     initialized_ = true;
+    dither_error_ = 0.0f;
     set(0.0f); // Initialize to off
 }
 
@@ -49,8 +50,7 @@ void PWMDriver::set(float percentage) {
     
     current_duty_ = util::clipf(percentage, 0.0f, 1.0f);
     
-    const uint32_t max_value = (1U << config_.resolution_bits) - 1;
-    const uint32_t pwm_value = static_cast<uint32_t>(current_duty_ * max_value);
+    const uint32_t pwm_value = dithering_ ? toDitheredDuty(current_duty_) : toDuty(current_duty_);
     
 #ifdef ARDUINO_ARCH_ESP32
     ledcWrite(config_.pin, pwm_value);
@@ -59,6 +59,35 @@ void PWMDriver::set(float percentage) {
 #endif
 }
 
+void PWMDriver::setDuty(uint32_t duty) {
+    if (!initialized_) return;
+    
+    const uint32_t max_value = maxDuty();
+    if (duty > max_value) duty = max_value;
+    current_duty_ = float(duty) / float(max_value);
+    
+#ifdef ARDUINO_ARCH_ESP32
+    ledcWrite(config_.pin, duty);
+#else
+    analogWrite(config_.pin, duty);
+#endif
+}
+
+uint32_t PWMDriver::toDitheredDuty(float percentage) {
+    if (!(percentage > 0.0f)) {
+        dither_error_ = 0.0f; // off is off, no leftover pulse
+        return 0;
+    }
+    
+    const uint32_t max_value = maxDuty();
+    const float exact = util::clipf(percentage, 0.0f, 1.0f) * float(max_value) + dither_error_;
+    
+    uint32_t duty = static_cast<uint32_t>(exact); // floor, exact >= 0
+    if (duty > max_value) duty = max_value;
+    dither_error_ = exact - float(duty);
+    return duty;
+}
+
 void PWMDriver::updateConfig(const PWMConfig& new_config) {
     if (config_.pin != new_config.pin) {
         // Different pin, need full reinitialization
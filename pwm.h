@@ -45,6 +45,46 @@ public:
      */
     void set(float percentage);
     
+    /**
+     * @brief Set the raw duty register value
+     * @param duty 0 to maxDuty(), see toDuty()
+     */
+    void setDuty(uint32_t duty);
+    
+    /**
+     * @brief Quantize a duty cycle to the configured resolution
+     * @param percentage Duty cycle (0.0 to 1.0)
+     * @return Register value, as written by set()
+     */
+    [[nodiscard]] uint32_t toDuty(float percentage) const {
+        return static_cast<uint32_t>(util::clipf(percentage, 0.0f, 1.0f) * maxDuty());
+    }
+    
+    [[nodiscard]] uint32_t maxDuty() const { return (1U << config_.resolution_bits) - 1; }
+    
+    /**
+     * @brief Enable sigma-delta dithering in set() / toDitheredDuty()
+     *
+     * The rounding error of each duty is carried into the next one, so the
+     * average over successive writes matches the float duty far below one
+     * LSB (8 bit PWM averages to 16+ bits over 256 writes), without raising
+     * the resolution and lowering the frequency. The output toggles between
+     * two neighbouring steps; a fraction f of an LSB repeats every 1/f writes,
+     * so write often (every loop tick) for the pattern not to be visible.
+     */
+    void setDithering(bool enabled) {
+        dithering_ = enabled;
+        dither_error_ = 0.0f;
+    }
+    [[nodiscard]] bool isDithering() const { return dithering_; }
+    
+    /**
+     * @brief Quantize with error diffusion, call once per written duty
+     * @param percentage Duty cycle (0.0 to 1.0), 0 clears the carried error
+     * @return Register value, floor or ceil of the exact duty
+     */
+    uint32_t toDitheredDuty(float percentage);
+        
     /**
      * @brief Get current duty cycle
      * @return Current duty cycle (0.0 to 1.0)
@@ -77,6 +117,8 @@ private:
     
     PWMConfig config_;
     float current_duty_ = 0.0f;
+    float dither_error_ = 0.0f; // 0..1 LSB carried to the next duty
+    bool dithering_ = false;
     uint8_t channel_ = 0;
     bool initialized_ = false;
     
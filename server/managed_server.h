@@ -170,13 +170,21 @@ public:
         if (timeElapsed > 2)
         {
             timeElapsed = 0;
-            if (_soft_AP_active)
-                pDnsServer->processNextRequest();
-                // dnsServer.processNextRequest();
+            update();
         }
 #endif
     }
 
+    // ungated loop(), for util::Scheduler tasks
+    void update()
+    {
+#if ENABLE_DNS_SERVER
+        if (_soft_AP_active)
+            pDnsServer->processNextRequest();
+            // dnsServer.processNextRequest();
+#endif
+    }
+
 private:
     bool _soft_AP_active = true;
 
@@ -31,12 +31,19 @@ public:
         static lpsd_ms timeElapsed;
         if (timeElapsed > 5)
         {
-        for (auto param : pData->getParameter_changed_from_code())
-            sendJson(param);
+            timeElapsed = 0;
+            sendChanged();
         }
 #endif
     }
 
+    // sends parameters changed from code, for util::Scheduler tasks (with SocketServer::loop())
+    void sendChanged()
+    {
+        for (auto param : pData->getParameter_changed_from_code())
+            sendJson(param);
+    }
+
     
     // Sends a JSON object to all connected WebSocket clients
     void sendJson(const ParameterData::Parameter* pParam)
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <SPIFFS.h>
+
+#include "../led_timeline.h"
+
+// ---------------------------------------------------------------------------------------
+// util::led::Timeline from JSON, e.g. a wake-up light curve in /sunrise.json:
+//
+// {
+//   "loop": false,
+//   "keyframes": [
+//     {"t": 0, "v": 0},
+//     {"t": 1200000, "v": 0.3, "curve": "log"},
+//     {"t": 1800000, "v": 1.0, "curve": "ease"}
+//   ]
+// }
+//
+// t in ms, v 0..1, curve "step", "linear" (default), "ease" or "log" from the
+// previous keyframe. Parsed and compiled once (setup), the JSON is not kept.
+//
+// util::led::Timeline sunrise;
+// if (loadTimeline(sunrise, "/sunrise.json"))
+//   led.setTimeline(sunrise);
+// ---------------------------------------------------------------------------------------
+
+inline bool parseTimeline(util::led::Timeline& timeline, JsonVariantConst json)
+{
+    timeline.clear();
+    timeline.setLoop(json["loop"].as<bool>());
+
+    JsonArrayConst keyframes = json["keyframes"];
+    if (keyframes.size() == 0)
+    {
+        printf("ERROR in parseTimeline: no keyframes\n");
+        return false;
+    }
+
+    for (size_t i = 0; i < keyframes.size(); i++)
+    {
+        JsonVariantConst keyframe = keyframes[i];
+
+        util::led::Timeline::Curve curve = util::led::Timeline::Curve::LINEAR;
+        const char*                name  = keyframe["curve"];
+        if (name && !util::led::Timeline::curveFromName(name, curve))
+        {
+            printf("ERROR in parseTimeline: unknown curve '%s'\n", name);
+            return false;
+        }
+        if (!timeline.add(keyframe["t"].as<uint32_t>(), keyframe["v"].as<float>(), curve))
+            return false;
+    }
+    return true;
+}
+
+inline bool loadTimeline(util::led::Timeline& timeline, const char* path)
+{
+    File file = SPIFFS.open(path, "r");
+    if (!file)
+    {
+        printf("ERROR in loadTimeline: failed to open %s\n", path);
+        return false;
+    }
+
+    // every keyframe an object with up to 3 members, plus copied strings
+    DynamicJsonDocument doc(JSON_OBJECT_SIZE(2) + JSON_ARRAY_SIZE(util::led::Timeline::MAX_SEGMENTS) +
+                            util::led::Timeline::MAX_SEGMENTS * JSON_OBJECT_SIZE(3) + 512);
+    const DeserializationError error = deserializeJson(doc, file);
+    file.close();
+    if (error)
+    {
+        printf("ERROR in loadTimeline: %s: %s\n", path, error.c_str());
+        return false;
+    }
+    return parseTimeline(timeline, doc.as<JsonVariantConst>());
+}
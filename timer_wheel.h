@@ -0,0 +1,325 @@
+#pragma once
+
+/**
+ * @file timer_wheel.h
+ * @brief Hierarchical timer wheel for many software timers (one-shot and periodic)
+ *
+ * 4 levels of 64 slots, 6 bits of the tick counter each (2^24 ticks = 4.6 h
+ * at 1 ms, longer delays are re-cascaded). start()/stop() are O(1), a tick
+ * only looks at one level 0 slot and every 64th tick moves one slot of the
+ * next level down, so the cost per tick does not depend on how many timers
+ * are pending. Timers live in a fixed pool, nothing is allocated after
+ * construction.
+ *
+ * Inside a callback create()/once(), start(), stop() and release() may be
+ * called for any timer, including the one that is firing: releasing it
+ * ("stop after N runs") takes effect when its callback returns, so the
+ * running callback is not destroyed. update()/advance()/tick() must not be
+ * called from a callback.
+ *
+ * Usage:
+ *
+ * util::TimerWheel<1024> timers; // 1 ms tick
+ *
+ * int save = timers.create([] { parameters.save(); });
+ * timers.start(save, 2000);                // debounce: restart on every change
+ * timers.start(timers.create(blink), 500, 500); // periodic
+ * timers.once(100, [] { led.set(0); });    // released after firing
+ *
+ * void loop() {
+ *   timers.update(); // runs all ticks since the last call
+ * }
+ */
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#include "arduino_time.h"
+
+namespace util {
+
+template <int MAX_TIMERS = 256, typename CALLBACK = std::function<void()>>
+class TimerWheel
+{
+    static_assert(MAX_TIMERS > 0 && MAX_TIMERS < 32768, "MAX_TIMERS must fit int16_t");
+
+public:
+    using Callback = CALLBACK;
+
+    static constexpr int      LEVELS    = 4;
+    static constexpr int      SLOT_BITS = 6;
+    static constexpr int      SLOTS     = 1 << SLOT_BITS;
+    static constexpr uint32_t SLOT_MASK = SLOTS - 1;
+    static constexpr uint32_t MAX_DELTA = (uint32_t(1) << (LEVELS * SLOT_BITS)) - 1; // ticks
+
+    explicit TimerWheel(uint32_t tick_us = 1000) : _tick_us(tick_us)
+    {
+        for (auto& head : _heads)
+            head = NONE;
+        for (int i = 0; i < MAX_TIMERS; i++)
+            _timers[i].next = int16_t(i + 1 < MAX_TIMERS ? i + 1 : NONE);
+        _free = 0;
+        _last_us = now_us();
+    }
+
+    /**
+     * @brief Take a timer from the pool (not started)
+     * @return timer id, -1 if the pool is empty
+     */
+    int create(Callback callback)
+    {
+        if (_free == NONE)
+        {
+            printf("ERROR in util::TimerWheel: more than %d timers\n", MAX_TIMERS);
+            return -1;
+        }
+        const int id = _free;
+        Timer&    t  = _timers[id];
+        _free        = t.next;
+        t.callback   = std::move(callback);
+        t.slot       = NONE;
+        t.in_use     = true;
+        t.once       = false;
+        _used++;
+        return id;
+    }
+
+    /**
+     * @brief (Re)start a timer, restarting a running timer moves its deadline
+     * @param delay_ticks first expiry, 0 = on the next tick
+     * @param period_ticks 0 = one-shot
+     */
+    void start(int id, uint32_t delay_ticks, uint32_t period_ticks = 0)
+    {
+        Timer& t = _timers[id];
+        unlink(id);
+        t.period  = period_ticks;
+        t.expires = _now + (delay_ticks > 0 ? delay_ticks : 1);
+        insert(id);
+    }
+
+    void stop(int id) { unlink(id); }
+
+    // stop and return to the pool (deferred until its callback returns when called from it)
+    void release(int id)
+    {
+        Timer& t = _timers[id];
+        if (!t.in_use)
+            return;
+        unlink(id);
+        if (id == _firing)
+        {
+            _release_firing = true;
+            return;
+        }
+        t.in_use   = false;
+        t.callback = Callback();
+        t.next     = _free;
+        _free      = int16_t(id);
+        _used--;
+    }
+
+    /**
+     * @brief One-shot timer that is released after it fired
+     * @return timer id (only valid until it fired), -1 if the pool is empty
+     */
+    int once(uint32_t delay_ticks, Callback callback)
+    {
+        const int id = create(std::move(callback));
+        if (id < 0)
+            return -1;
+        _timers[id].once = true;
+        start(id, delay_ticks);
+        return id;
+    }
+
+    bool isActive(int id) const { return _timers[id].slot != NONE; }
+
+    // ticks until the timer fires, 0 if stopped
+    uint32_t remaining(int id) const { return isActive(id) ? _timers[id].expires - _now : 0; }
+
+    /**
+     * @brief Advance by the time passed since the last update()
+     */
+    void update()
+    {
+        const time_us now = now_us();
+        if (now - _last_us < _tick_us)
+            return;
+        const time_us ticks = (now - _last_us) / _tick_us;
+        _last_us += ticks * _tick_us; // keeps the remainder, no drift
+        advance(uint32_t(ticks));
+    }
+
+    // advance by a number of ticks, running every timer that expires on the way
+    void advance(uint32_t ticks)
+    {
+        while (ticks--)
+            tick();
+    }
+
+    void tick()
+    {
+        _now++;
+
+        // every 64 ticks one slot of the next level moves down (and so on)
+        for (int level = 1; level < LEVELS; level++)
+        {
+            if (((_now >> ((level - 1) * SLOT_BITS)) & SLOT_MASK) != 0)
+                break;
+            cascade(level, (_now >> (level * SLOT_BITS)) & SLOT_MASK);
+        }
+
+        // detach the due slot first: callbacks may start/stop any timer
+        const int due = int(_now & SLOT_MASK);
+        if (_heads[due] == NONE)
+            return;
+        moveSlot(due, PENDING);
+
+        while (_heads[PENDING] != NONE)
+        {
+            const int id = _heads[PENDING];
+            Timer&    t  = _timers[id];
+            unlink(id);
+
+            if (t.expires != _now) // parked beyond MAX_DELTA
+            {
+                insert(id);
+                continue;
+            }
+
+            if (t.once)
+            {
+                Callback callback = std::move(t.callback);
+                release(id);
+                callback();
+                continue;
+            }
+
+            if (t.period > 0)
+            {
+                t.expires += t.period; // keeps the phase
+                insert(id);
+            }
+            _firing = int16_t(id);
+            t.callback();
+            _firing = NONE;
+            if (_release_firing)
+            {
+                _release_firing = false;
+                release(id);
+            }
+        }
+    }
+
+    uint32_t now() const { return _now; } // ticks
+    uint32_t tickPeriod_us() const { return _tick_us; }
+    int      size() const { return _used; }
+    static constexpr int capacity() { return MAX_TIMERS; }
+
+private:
+    static constexpr int16_t NONE    = -1;
+    static constexpr int     PENDING = LEVELS * SLOTS; // list being run in tick()
+
+    struct Timer
+    {
+        uint32_t expires = 0; // absolute tick
+        uint32_t period  = 0;
+        int16_t  prev    = NONE;
+        int16_t  next    = NONE;
+        int16_t  slot    = NONE; // index into _heads, NONE = not scheduled
+        bool     in_use  = false;
+        bool     once    = false;
+        Callback callback;
+    };
+
+    Timer   _timers[MAX_TIMERS];
+    int16_t _heads[LEVELS * SLOTS + 1];
+    int16_t _free = NONE;
+    int     _used = 0;
+
+    int16_t _firing         = NONE;  // timer whose callback is running (in place)
+    bool    _release_firing = false; // release() of it, done when the callback returns
+
+    uint32_t _now = 0; // ticks
+    uint32_t _tick_us;
+    time_us  _last_us = 0;
+
+    void insert(int id)
+    {
+        Timer&   t     = _timers[id];
+        uint32_t delta = t.expires - _now;
+        uint32_t when  = t.expires;
+        if (int32_t(delta) < 0) // overdue: next tick
+        {
+            t.expires = _now + 1;
+            delta     = 1;
+            when      = t.expires;
+        }
+        else if (delta > MAX_DELTA) // park in the last slot reachable, re-inserted from there
+        {
+            delta = MAX_DELTA;
+            when  = _now + MAX_DELTA;
+        }
+
+        int level = 0;
+        while (level < LEVELS - 1 && delta >= (uint32_t(1) << ((level + 1) * SLOT_BITS)))
+            level++;
+
+        const int slot = level * SLOTS + int((when >> (level * SLOT_BITS)) & SLOT_MASK);
+        link(id, slot);
+    }
+
+    void cascade(int level, uint32_t index)
+    {
+        const int slot = level * SLOTS + int(index);
+        if (_heads[slot] == NONE)
+            return;
+        moveSlot(slot, PENDING);
+        while (_heads[PENDING] != NONE)
+        {
+            const int id = _heads[PENDING];
+            unlink(id);
+            insert(id);
+        }
+    }
+
+    void link(int id, int slot)
+    {
+        Timer& t = _timers[id];
+        t.slot   = int16_t(slot);
+        t.prev   = NONE;
+        t.next   = _heads[slot];
+        if (t.next != NONE)
+            _timers[t.next].prev = int16_t(id);
+        _heads[slot] = int16_t(id);
+    }
+
+    void unlink(int id)
+    {
+        Timer& t = _timers[id];
+        if (t.slot == NONE)
+            return;
+        if (t.prev != NONE)
+            _timers[t.prev].next = t.next;
+        else
+            _heads[t.slot] = t.next;
+        if (t.next != NONE)
+            _timers[t.next].prev = t.prev;
+        t.slot = NONE;
+        t.prev = NONE;
+        t.next = NONE;
+    }
+
+    // only walks the list to update the slot field, no re-linking
+    void moveSlot(int from, int to)
+    {
+        _heads[to]   = _heads[from];
+        _heads[from] = NONE;
+        for (int16_t id = _heads[to]; id != NONE; id = _timers[id].next)
+            _timers[id].slot = int16_t(to);
+    }
+};
+
+} // namespace util
@@ -8,7 +8,10 @@
 #include "arduino_time.h"
 
 #include "basics.h"
+#include "basics_batch.h"
 #include "filter.h"
+#include "timer_wheel.h"
+#include "concurrency.h"
 
 
 // TODO more documentation